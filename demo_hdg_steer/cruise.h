@@ -0,0 +1 @@
+../kintobor/cruise.h
\ No newline at end of file
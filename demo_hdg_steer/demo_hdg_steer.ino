@@ -6,188 +6,155 @@
  * This file demos the robot's ability to steer towards a heading angle. As the
  * robot is turned, the front wheels should point in the direction that would
  * get the robot to steer towards the desired heading.
+ *
+ * The drivers and the heading control come from the kintobor core; the
+ * features this demo uses are selected in kintobor_config.h. Without
+ * navigation, the controller steers by the compass heading alone.
  */
 #include <stdint.h>
 
 #include "kintobor.h"
 
-/* The MAINLOOP_PERIOD_TICKS value should be some fraction of:
- * 16,000,000 / prescaler
- * Remember: the timer starts counting from zero; so subtract 1
- */
-#define MAINLOOP_PERIOD_TICKS   6249    // loop period is 25 ms
+#define MISSION_TIMEOUT_FRAMES (90 * SCHED_FRAMES_PER_SEC) // 90 seconds
 
-#define MISSION_TIMEOUT 3600 // 40 iterations/sec * 5 sec = 200 cycles
 statevars_t statevars;
-uint32_t iterations;
 
-volatile uint8_t system_timer_overflow = 0; // indicates mainloop overflow
-/* Interrupt Service Routine that triggers when the main loop is running longer
- * than it should.
+static void control_output_task(void);
+static void print_task(void);
+static uint8_t telemetry_job(void);
+
+// The telemetry line is printed one field per job step, and only once the
+// serial port's transmit buffer has room for the field, so printing never
+// waits for the serial port
+#define TELEMETRY_FIELD_BYTES   24      // the longest label with its value
+#define TELEMETRY_STEP_TICKS    (SCHED_TICKS_PER_MS / 2)
+
+// The values of the line being printed, as they were when print_task ran
+static float telemetry_desired;
+static float telemetry_actual;
+static float telemetry_control;
+static uint16_t telemetry_commanded;
+static uint8_t telemetry_field;         // the next field; 0 when not printing
+
+/* The mission task table. Tasks run in the order listed, which is sorted by
+ * deadline. Frames are 10 ms long, so a period of 10 frames is 10 Hz.
  */
-ISR(TIMER1_OVF_vect) {
-  system_timer_overflow = 1;
-}
+static const sched_task_t mission_tasks[] = {
+  // run                        period  offset  deadline
+  { compass_update_all,         1,      0,      6 * SCHED_TICKS_PER_MS },
+  { update_nav_control_values,  CONTROL_PERIOD_FRAMES, 0, SCHED_FRAME_TICKS },
+  { control_output_task,        2,      0,      SCHED_FRAME_TICKS },
+  { print_task,                 10,     5,      SCHED_FRAME_TICKS }
+};
+
+#define NUM_MISSION_TASKS (sizeof(mission_tasks) / sizeof(mission_tasks[0]))
 
 void setup() {
+  // Cleared before the boot so that the boot time makes it into the records
+  clear_statevars();
+  statevars.prefix = 0xDADAFEED;
+  statevars.suffix = 0xCAFEBABE;
 
-  if (init_all_subsystems()) {
+  if (boot_all_subsystems(NULL, 0)) {
     uwrite_print_buff("All systems ready!\r\n");
   } else {
     uwrite_print_buff("There was a subsystem failure\r\n");
     exit(0);
   }
 
-  clear_statevars();
-  statevars.prefix = 0xDADAFEED;
-  statevars.suffix = 0xCAFEBABE;
-
-  iterations = 0;
-
-  configure_mainloop_timer();
-  enable_mainloop_timer();
-
-  mobility_blocking_stop();
-  mobility_steer(TURN_NEUTRAL);
+  if (!sched_init(mission_tasks, NUM_MISSION_TASKS)) {
+    uwrite_print_buff("The mission task table is invalid\r\n");
+    exit(0);
+  }
 
   update_all_inputs();
   update_nav_control_values();
   uwrite_print_buff("Mission started!\r\n");
 
-  // statevars.mobility_steering_pwm = TURN_NEUTRAL;
-  statevars.control_steering_pwm = TURN_NEUTRAL;
-
   Serial.begin(115200);
+
+  sched_start();
 }
 
 void loop() {
-  TCNT1 = 0;
+  sched_run_frame();
 
-  // Take note if the system timer (TIMER1) had an overflow
-  if (system_timer_overflow) {
-    statevars.status |= STATUS_SYS_TIMER_OVERFLOW;
+  // Stop the robot after a certain number of seconds
+  if (sched_get_frame_count() > MISSION_TIMEOUT_FRAMES) {
+    mobility_hardstop();
+    exit(0);
   }
+}
 
-  // Set the control values from the previous iteration
-  // Rationale: Based on initial testing, I suspect the output compare register
-  // values that shape the PWM signals isn't being set early enough because
-  // the floating-point calculations in update_nav_control_values() takes a
-  // while. So I'll carryover the PWM values from the previous iteration and
-  // set them at the start of the new iteration.
-  mobility_start_control_output();
-  // mobility_steer(statevars.mobility_steering_pwm);
+// Points the wheels; the robot itself stays put
+static void control_output_task(void) {
   mobility_steer(statevars.control_steering_pwm);
   mobility_stop();
 
-  // Reset statevars and timer overflow flag
-  statevars.status = 0;
+  return;
+}
 
-  statevars.main_loop_counter = iterations;
-  system_timer_overflow = 0;
+/* Takes the values for a line of telemetry and has the telemetry job print
+ * it. If the previous line is still being printed, this one is skipped.
+ */
+static void print_task(void) {
+  if (telemetry_field != 0) {
+    return;
+  }
 
-  update_all_inputs();
+  telemetry_desired = statevars.control_heading_desired;
 
-  update_nav_control_values();
+  // The heading the controller steered by, back from its error
+  telemetry_actual = telemetry_desired - statevars.control_xtrack_error;
+  if (telemetry_actual < 0.0) {
+    telemetry_actual += 360.0;
+  } else if (telemetry_actual >= 360.0) {
+    telemetry_actual -= 360.0;
+  }
 
-  iterations++;
+  telemetry_control = statevars.control_steering_pwm;
+  telemetry_commanded = statevars.mobility_steering_pwm;
 
-  Serial.print("target: ");
-  Serial.print(270.0);
-  Serial.print(", actual: ");
-  Serial.print(statevars.nav_heading_deg);
-  Serial.print(", control: ");
-  Serial.print(statevars.control_steering_pwm);
-  Serial.print(", commanded: ");
-  Serial.println(statevars.mobility_steering_pwm << 2);
+  if (sched_post_job(telemetry_job, TELEMETRY_STEP_TICKS)) {
+    telemetry_field = 1;
+  }
 
-  // If the button switched to the OFF position, then stop the mission
-  //if (!button_is_pressed()) {
-  // Instead, stop the robot after a certain number of seconds
-  if (iterations > MISSION_TIMEOUT) {
-    mobility_blocking_stop();
+  return;
+}
 
-    exit(0);
+/* Background job that prints the next field of the telemetry line.
+ * Returns SCHED_JOB_MORE while fields are left to print
+ */
+static uint8_t telemetry_job(void) {
+  if (Serial.availableForWrite() < TELEMETRY_FIELD_BYTES) {
+    return SCHED_JOB_WAIT;
   }
 
-  /* Ensure that the main loop period is as long as we want it to be.
-   * This means (1) triggering the main loop to restart when we notice it is
-   * running too long, and (2) performing busy waiting if the instructions
-   * above finish before the desired loop duration.
-   */
-   if (TCNT1 > MAINLOOP_PERIOD_TICKS) {
-     statevars.status |= STATUS_MAIN_LOOP_LATE;
-
-     // Jump to the start of loop() by calling return. Normally we would use
-     // continue to go to the beginning of a loop, but in this case, loop() is
-     // a function. And when you return from loop() it gets called again by
-     // main.cpp.
-     return;
-   }
-
-  while (1) {
-    // System timer reached 250,000
-    if (system_timer_overflow) {
+  switch (telemetry_field) {
+    case 1:
+      Serial.print("target: ");
+      Serial.print(telemetry_desired);
       break;
-    }
-
-    // Main loop timer reached 6250
-    if (TCNT1 > MAINLOOP_PERIOD_TICKS) {
+    case 2:
+      Serial.print(", actual: ");
+      Serial.print(telemetry_actual);
+      break;
+    case 3:
+      Serial.print(", control: ");
+      Serial.print(telemetry_control);
       break;
-    }
+    default:
+      Serial.print(", commanded: ");
+      Serial.println(telemetry_commanded);
+      telemetry_field = 0;
+      return SCHED_JOB_DONE;
   }
 
+  telemetry_field++;
+
+  return SCHED_JOB_MORE;
 }
 
 void clear_statevars(void) {
   memset(&statevars, 0, sizeof(statevars));
 }
-
-void configure_mainloop_timer(void) {
-  cli();
-
-  /* We need to use a timer to control how long our main loop iterations are.
-   * Here we are configuring Timer1 because it is a "16-bit" timer, which would
-   * allow use to count to values greater than the usual (2^8)-1. For a
-   * prescale value of 64, the timer will count up to 16,000,000/64 = 250,000.
-   * This gives us a timer period of 250,000 ticks/sec = 4 microseconds/tick.
-   * Suppose we want the main loop to run 40 times per second (40 Hz), we would
-   * need to restart the loop when Timer1 reaches the value: 250,000/40 = 6250.
-   * See Atmel datasheet for Mega, Section 17.11
-   */
-  TCCR1A = 0b00000000; // Normal operation; no waveform generation by default
-  TCCR1B = 0b00000011; // No input capture, waveform gen; prescaler = 64
-  TCCR1C = 0b00000000; // No output compare
-  TIMSK1 = 0b00000000; // Ensure overflow interrupt is disabled for now
-
-  sei();
-
-  return;
-}
-
-void enable_mainloop_timer(void) {
-  TIMSK1 = 0b00000001;
-
-  return;
-}
-
-// TODO Shift this function into the higher-order functions group, but
-// separate the sdcard_init() since it won't be recognized by the AVR code
-uint8_t init_all_subsystems(void) {
-  uwrite_init();
-
-  if (!cmps10_init()) {
-    uwrite_print_buff("Compass couldn't be initialized\r\n");
-    return 0;
-  } else {
-    uwrite_print_buff("Compass is ready!\r\n");
-  }
-
-  if (!mobility_init()) {
-    uwrite_print_buff("Mobility couldn't be initialized\r\n");
-    return 0;
-  } else {
-    uwrite_print_buff("Mobility is ready!\r\n");
-  }
-
-  return 1;
-}
@@ -0,0 +1 @@
+../kintobor/motion_profile.c
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/motion_profile.h
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/boot.c
\ No newline at end of file
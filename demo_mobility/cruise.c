@@ -0,0 +1 @@
+../kintobor/cruise.c
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/timebase.c
\ No newline at end of file
@@ -1,11 +0,0 @@
-/*
- * file: kintobor.c
- * created: 20160709
- * author(s): mr-augustine
- *
- * The kintobor implementation file defines all of the robot's higher-order
- * functions.
- */
-#include "kintobor.h"
-
-// No higher-order functions for this demo
@@ -1,24 +0,0 @@
-/*
- * file: kintobor.h
- * created: 20160708
- * author(s): mr-augustine
- *
- * The kintobor header file lists function prototypes for all of the robot's
- * higher-order functions.
- */
-#ifndef _KINTOBOR_H_
-#define _KINTOBOR_H
-
-#include "odometer.h"
-#include "uwrite.h"
-
-#define ROBOT_NAME          ("kintobor")
-#define METERS_PER_TICK     0.000012345
-
-#ifdef __cplusplus
-extern "C" {
-  // No higher-order functions for this demo
-}
-#endif // #ifdef __cplusplus
-
-#endif // #ifndef _KINTOBOR_H_
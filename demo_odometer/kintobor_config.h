@@ -0,0 +1,14 @@
+/*
+ * file: kintobor_config.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Selects the kintobor features that the odometer demo is built with; see
+ * kintobor_features.h for the others.
+ */
+#ifndef _KINTOBOR_CONFIG_H_
+#define _KINTOBOR_CONFIG_H_
+
+#define KINTOBOR_WITH_ODOMETER  1
+
+#endif // #ifndef _KINTOBOR_CONFIG_H_
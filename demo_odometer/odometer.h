@@ -0,0 +1 @@
+../kintobor/odometer.h
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/ram.c
\ No newline at end of file
@@ -0,0 +1,16 @@
+/*
+ * file: kintobor_config.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Selects the kintobor features that the sdcard_gps demo is built with; see
+ * kintobor_features.h for the others.
+ */
+#ifndef _KINTOBOR_CONFIG_H_
+#define _KINTOBOR_CONFIG_H_
+
+#define KINTOBOR_WITH_BUTTON    1
+#define KINTOBOR_WITH_GPS       1
+#define KINTOBOR_WITH_SDCARD    1
+
+#endif // #ifndef _KINTOBOR_CONFIG_H_
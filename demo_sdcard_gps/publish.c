@@ -0,0 +1 @@
+../kintobor/publish.c
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/kintobor.h
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/kintobor_features.h
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/boot.h
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/compass_lut.h
\ No newline at end of file
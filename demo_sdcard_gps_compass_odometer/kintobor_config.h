@@ -0,0 +1,20 @@
+/*
+ * file: kintobor_config.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Selects the kintobor features that the sdcard_gps_compass_odometer demo is
+ * built with; see kintobor_features.h for the others.
+ */
+#ifndef _KINTOBOR_CONFIG_H_
+#define _KINTOBOR_CONFIG_H_
+
+#define KINTOBOR_WITH_BUTTON    1
+#define KINTOBOR_WITH_GPS       1
+#define KINTOBOR_WITH_COMPASS   1
+#define KINTOBOR_WITH_ODOMETER  1
+#define KINTOBOR_WITH_SDCARD    1
+
+#define COMPASS_MODEL           COMPASS_CMPS10
+
+#endif // #ifndef _KINTOBOR_CONFIG_H_
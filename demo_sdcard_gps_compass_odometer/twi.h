@@ -0,0 +1 @@
+../kintobor/twi.h
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/twi_master.h
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/compass.h
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/kintobor.c
\ No newline at end of file
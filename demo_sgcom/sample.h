@@ -0,0 +1 @@
+../kintobor/sample.h
\ No newline at end of file
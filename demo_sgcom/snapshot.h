@@ -0,0 +1 @@
+../kintobor/snapshot.h
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/statevars.h
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/twi_master.c
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/gps.h
\ No newline at end of file
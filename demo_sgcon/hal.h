@@ -0,0 +1 @@
+../kintobor/hal.h
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/ledbutton.c
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/ledbutton.h
\ No newline at end of file
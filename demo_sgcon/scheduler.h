@@ -0,0 +1 @@
+../kintobor/scheduler.h
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/sdcard.ino
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/uwrite.c
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/gps.c
\ No newline at end of file
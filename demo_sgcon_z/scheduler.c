@@ -0,0 +1 @@
+../kintobor/scheduler.c
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/timebase.h
\ No newline at end of file
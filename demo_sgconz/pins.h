@@ -0,0 +1 @@
+../kintobor/pins.h
\ No newline at end of file
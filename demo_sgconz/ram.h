@@ -0,0 +1 @@
+../kintobor/ram.h
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/uwrite.h
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/compass.c
\ No newline at end of file
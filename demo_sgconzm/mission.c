@@ -0,0 +1 @@
+../kintobor/mission.c
\ No newline at end of file
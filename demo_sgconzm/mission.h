@@ -0,0 +1 @@
+../kintobor/mission.h
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/mobility.c
\ No newline at end of file
@@ -0,0 +1 @@
+../kintobor/mobility.h
\ No newline at end of file
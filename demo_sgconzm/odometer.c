@@ -0,0 +1 @@
+../kintobor/odometer.c
\ No newline at end of file
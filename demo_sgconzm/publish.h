@@ -0,0 +1 @@
+../kintobor/publish.h
\ No newline at end of file
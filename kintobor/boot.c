@@ -0,0 +1,128 @@
+/*
+ * file: boot.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Defines the boot sequencer. The timebase has to be running before
+ * boot_begin() is called, since every step is timed against it.
+ */
+#include <stdint.h>
+
+#include "boot.h"
+#include "statevars.h"
+#include "timebase.h"
+#include "uwrite.h"
+
+static const boot_step_t * steps[BOOT_MAX_STEPS];
+static uint16_t ready_ms[BOOT_MAX_STEPS];
+static uint8_t num_steps;
+static uint8_t failed;        // one bit per step that couldn't be started
+static uint8_t not_ready;     // one bit per step that isn't ready yet
+static uint8_t required;      // one bit per step the boot can't do without
+static uint32_t began_at;
+
+// Returns the milliseconds since boot_begin()
+static uint16_t elapsed_ms(void) {
+  uint32_t ms = (timebase_now() - began_at) / TIMEBASE_TICKS_PER_MS;
+
+  return (ms > UINT16_MAX) ? UINT16_MAX : ms;
+}
+
+void boot_begin(void) {
+  num_steps = 0;
+  failed = 0;
+  not_ready = 0;
+  required = 0;
+  began_at = timebase_now();
+
+  return;
+}
+
+/* Starts every step in the table, in order, and adds them to the steps that
+ * boot_wait() waits for. A step that fails to start is never ready.
+ * Returns 1 if every step that isn't optional started; 0 otherwise
+ */
+uint8_t boot_start(const boot_step_t * table, uint8_t count) {
+  uint8_t all_started = 1;
+  uint8_t i;
+
+  for (i = 0; i < count; i++) {
+    if (num_steps == BOOT_MAX_STEPS) {
+      return 0;
+    }
+
+    uint8_t step = num_steps++;
+    uint8_t bit = 1 << step;
+    steps[step] = &table[i];
+
+    if (!table[i].optional) {
+      required |= bit;
+    }
+
+    if (!table[i].start()) {
+      failed |= bit;
+      not_ready |= bit;
+      all_started = all_started && table[i].optional;
+    } else if (table[i].poll != NULL) {
+      not_ready |= bit;
+    } else {
+      ready_ms[step] = elapsed_ms();
+    }
+  }
+
+  return all_started;
+}
+
+/* Polls every step that isn't ready yet until they all are, or until
+ * timeout_ms after boot_begin(), and records how long that took.
+ * Returns 1 if every step that isn't optional is ready; 0 otherwise
+ */
+uint8_t boot_wait(uint16_t timeout_ms) {
+  while ((not_ready & ~failed) != 0 && elapsed_ms() < timeout_ms) {
+    uint8_t step;
+    for (step = 0; step < num_steps; step++) {
+      uint8_t bit = 1 << step;
+
+      if ((not_ready & ~failed & bit) && steps[step]->poll()) {
+        ready_ms[step] = elapsed_ms();
+        not_ready &= ~bit;
+      }
+    }
+  }
+
+  statevars.boot_ms = elapsed_ms();
+  statevars.boot_not_ready = not_ready;
+
+  return ((not_ready & required) == 0);
+}
+
+// Prints how each step did and how long the boot took
+void boot_report(void) {
+  uint8_t step;
+  for (step = 0; step < num_steps; step++) {
+    uint8_t bit = 1 << step;
+
+    uwrite_print_buff((char *) steps[step]->name);
+
+    if (failed & bit) {
+      uwrite_print_buff(" couldn't be initialized");
+    } else if (not_ready & bit) {
+      uwrite_print_buff(" didn't become ready in time");
+    } else {
+      uwrite_print_buff(" is ready! (ms) ");
+      uwrite_println_short(&ready_ms[step]);
+      continue;
+    }
+
+    if (required & bit) {
+      uwrite_print_buff("\r\n");
+    } else {
+      uwrite_print_buff("; carrying on without it\r\n");
+    }
+  }
+
+  uwrite_print_buff("Boot time (ms) ");
+  uwrite_println_short((void *) &statevars.boot_ms);
+
+  return;
+}
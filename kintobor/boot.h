@@ -0,0 +1,64 @@
+/*
+ * file: boot.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Lists the types and functions used by the boot sequencer. Some subsystems
+ * take a while to become ready after they are initialized: the ESC has to see
+ * neutral pulses for a few seconds before it arms, the GPS receiver has to
+ * send its first sentence, and the compass has to answer its first reading.
+ * None of that needs the CPU, so rather than bringing the subsystems up one
+ * after another, the sequencer starts every one of them right away and then
+ * waits for all of them together.
+ *
+ * Each subsystem is a boot step with a start function, which begins its
+ * initialization and returns 0 if it failed, and a poll function, which does
+ * any work the subsystem needs while it comes up and returns 1 once it is
+ * ready. A step without a poll function is ready as soon as it has started.
+ * An optional step is started and waited for like any other, but the boot
+ * succeeds without it.
+ * A start function that has to block (e.g., the SD card's) still overlaps with
+ * the steps started before it.
+ *
+ *   boot_begin();
+ *   boot_start(steps, num_steps);          // once per table of steps
+ *   if (boot_wait(BOOT_TIMEOUT_MS)) ...    // polls until all are ready
+ *   boot_report();                         // prints when each became ready
+ *
+ * boot_wait() stores the time from boot_begin() until every step was ready
+ * (or the timeout) in statevars.boot_ms, and one bit per step that wasn't
+ * ready, in the order the steps were started, in statevars.boot_not_ready;
+ * optional steps are included there too.
+ * Nothing is printed until boot_report(), so the serial port never holds up
+ * the boot.
+ *
+ * The extern "C" construct allows the main Arduino program to use the
+ * functions declared below.
+ */
+#ifndef _BOOT_H_
+#define _BOOT_H_
+
+#include <stdint.h>
+
+#define BOOT_MAX_STEPS    8
+#define BOOT_TIMEOUT_MS   5000    // the ESC alone needs about 2.5 seconds
+
+typedef struct {
+  const char * name;              // for boot_report()
+  uint8_t (*start)(void);         // returns 0 if the subsystem failed
+  uint8_t (*poll)(void);          // returns 1 once ready; NULL if no wait
+  uint8_t optional;               // 1 if the boot succeeds without it
+} boot_step_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif // #ifdef __cplusplus
+  void boot_begin(void);
+  uint8_t boot_start(const boot_step_t * steps, uint8_t num_steps);
+  uint8_t boot_wait(uint16_t timeout_ms);
+  void boot_report(void);
+#ifdef __cplusplus
+}
+#endif // #ifdef __cplusplus
+
+#endif // #ifndef _BOOT_H_
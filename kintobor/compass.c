@@ -0,0 +1,249 @@
+/*
+ * file: compass.c
+ * created: 20160906
+ * author(s): mr-augustine
+ *
+ * Defines the functions used to initialize and update the compass sensor.
+ *
+ * The compass is a client of the TWI master (see twi_master.h). Every update
+ * collects the result of the previous reading and queues the next one, so the
+ * reading happens on the bus while the rest of the frame runs. The heading,
+ * pitch, and roll (and optionally the raw magnetometer and accelerometer
+ * values) are read in a single burst starting at COMPASS_HEADING_REG; the
+ * compass increments the register address after each byte.
+ *
+ * The burst buffer belongs to the TWI master until the transaction finishes,
+ * so the two heading bytes are never read while they are being written.
+ *
+ * Samples are summed until COMPASS_AVG_SAMPLES of them have been collected,
+ * and then the averages are saved to statevars. Headings are summed as
+ * offsets from the first heading so that averaging 359.9 and 0.1 degrees
+ * gives 0.0 rather than 180.0 degrees.
+ *
+ * The averaged heading is then corrected for hard- and soft-iron distortion
+ * with the lookup table in compass_lut.h, if a calibration has been fit.
+ * statevars.heading_raw keeps the uncorrected heading so that the next
+ * calibration can be fit from any log.
+ *
+ * Each sample is timestamped when its reading finished on the bus. The
+ * average is stamped halfway between its first and last samples, which is
+ * the moment the averaged values best describe.
+ */
+#include <stddef.h>
+
+#include "compass.h"
+#if COMPASS_CORRECT_HEADING
+#include "compass_lut.h"
+#endif
+#include "sample.h"
+#include "statevars.h"
+#include "twi_master.h"
+
+// compass_lut.h has no table until a calibration has been fit
+#define CORRECT_WITH_LUT      (COMPASS_CORRECT_HEADING && COMPASS_LUT_CALIBRATED)
+
+#define HEADING_FULL_CIRCLE   (360 * COMPASS_HEADING_SCALE)
+#define HEADING_HALF_CIRCLE   (180 * COMPASS_HEADING_SCALE)
+
+#if COMPASS_READ_RAW
+#define COMPASS_BURST_LEN     (COMPASS_ACCEL_X_REG + 6 - COMPASS_HEADING_REG)
+#else
+#define COMPASS_BURST_LEN     (COMPASS_ROLL_REG + 1 - COMPASS_HEADING_REG)
+#endif
+
+// Position of each register in the burst buffer
+#define BURST_INDEX(reg)      ((reg) - COMPASS_HEADING_REG)
+
+// Converts a pitch or roll register to degrees
+#define ANGLE_DEG(reg)        ((int8_t) burst[BURST_INDEX(reg)])
+
+static const uint8_t first_register = COMPASS_HEADING_REG;
+static uint8_t burst[COMPASS_BURST_LEN];
+
+static twi_txn_t compass_txn = {
+  COMPASS_ADDR, &first_register, 1, burst, COMPASS_BURST_LEN, NULL, Twi_Idle, 0, 0
+};
+
+static uint8_t compass_enabled;
+
+// Running sums of the samples that haven't been averaged yet
+static uint8_t sample_count;
+static uint16_t first_heading;
+static uint32_t first_timestamp;
+static uint32_t last_timestamp;
+static int16_t heading_offset_sum;
+static int16_t pitch_sum;
+static int16_t roll_sum;
+#if COMPASS_READ_RAW
+static int32_t mag_sum[3];
+static int32_t accel_sum[3];
+#endif
+
+static uint16_t correct_heading(uint16_t heading);
+static int16_t read_int16(uint8_t reg);
+static void add_sample(uint32_t timestamp);
+static void save_average(void);
+
+/* Looks up the corrections for the whole degrees on either side of the
+ * heading and interpolates between them. Returns the corrected heading in
+ * tenths of a degree.
+ */
+static uint16_t correct_heading(uint16_t heading) {
+#if CORRECT_WITH_LUT
+  uint16_t index = heading / COMPASS_HEADING_SCALE;
+  uint8_t fraction = heading % COMPASS_HEADING_SCALE;
+
+  if (index >= COMPASS_LUT_ENTRIES) {
+    return heading;
+  }
+
+  uint16_t next = (index + 1 == COMPASS_LUT_ENTRIES) ? 0 : index + 1;
+  int16_t low = pgm_read_word(&compass_lut[index]);
+  int16_t high = pgm_read_word(&compass_lut[next]);
+
+  int16_t corrected = heading + low +
+      (high - low) * fraction / COMPASS_HEADING_SCALE;
+
+  if (corrected < 0) {
+    corrected += HEADING_FULL_CIRCLE;
+  } else if (corrected >= HEADING_FULL_CIRCLE) {
+    corrected -= HEADING_FULL_CIRCLE;
+  }
+
+  return corrected;
+#else
+  return heading;
+#endif
+}
+
+// Returns the big-endian 16-bit register value from the burst buffer
+static int16_t read_int16(uint8_t reg) {
+  return (int16_t) (((uint16_t) burst[BURST_INDEX(reg)] << 8) |
+                    burst[BURST_INDEX(reg) + 1]);
+}
+
+static void add_sample(uint32_t timestamp) {
+  uint16_t heading = read_int16(COMPASS_HEADING_REG);
+
+  if (sample_count == 0) {
+    first_heading = heading;
+    first_timestamp = timestamp;
+    heading_offset_sum = 0;
+    pitch_sum = 0;
+    roll_sum = 0;
+#if COMPASS_READ_RAW
+    uint8_t axis;
+    for (axis = 0; axis < 3; axis++) {
+      mag_sum[axis] = 0;
+      accel_sum[axis] = 0;
+    }
+#endif
+  }
+
+  // Offset from the first heading, wrapped to [-180.0, 180.0) degrees
+  int16_t offset = (int16_t) heading - (int16_t) first_heading;
+  if (offset >= HEADING_HALF_CIRCLE) {
+    offset -= HEADING_FULL_CIRCLE;
+  } else if (offset < -HEADING_HALF_CIRCLE) {
+    offset += HEADING_FULL_CIRCLE;
+  }
+
+  heading_offset_sum += offset;
+  pitch_sum += ANGLE_DEG(COMPASS_PITCH_REG);
+  roll_sum += ANGLE_DEG(COMPASS_ROLL_REG);
+
+#if COMPASS_READ_RAW
+  uint8_t axis;
+  for (axis = 0; axis < 3; axis++) {
+    mag_sum[axis] += read_int16(COMPASS_MAG_X_REG + 2 * axis);
+    accel_sum[axis] += read_int16(COMPASS_ACCEL_X_REG + 2 * axis);
+  }
+#endif
+
+  last_timestamp = timestamp;
+  sample_count++;
+
+  return;
+}
+
+static void save_average(void) {
+  int16_t heading = first_heading + heading_offset_sum / sample_count;
+
+  if (heading < 0) {
+    heading += HEADING_FULL_CIRCLE;
+  } else if (heading >= HEADING_FULL_CIRCLE) {
+    heading -= HEADING_FULL_CIRCLE;
+  }
+
+  statevars.heading_raw = heading;
+  statevars.heading_deg = correct_heading(heading) /
+      (float) COMPASS_HEADING_SCALE;
+  statevars.pitch_deg = pitch_sum / sample_count;
+  statevars.roll_deg = roll_sum / sample_count;
+
+#if COMPASS_READ_RAW
+  uint8_t axis;
+  for (axis = 0; axis < 3; axis++) {
+    statevars.compass_mag[axis] = mag_sum[axis] / sample_count;
+    statevars.compass_accel[axis] = accel_sum[axis] / sample_count;
+  }
+#endif
+
+  statevars.compass_samples = sample_count;
+  sample_stamp(&statevars.compass_meta,
+               first_timestamp + (last_timestamp - first_timestamp) / 2, 1);
+  sample_count = 0;
+
+  return;
+}
+
+/* Initialzes the compass. The TWI master must already be initialized; see
+ * twi_init().
+ */
+uint8_t compass_init(void) {
+  compass_txn.status = Twi_Idle;
+  sample_count = 0;
+  sample_reset(&statevars.compass_meta);
+
+  compass_enabled = 1;
+
+  return compass_enabled;
+}
+
+/* Adds the last reading to the running average, saves the average to
+ * statevars once enough samples have been collected, and requests the next
+ * reading from the compass
+ */
+void compass_update_all(void) {
+  if (!compass_enabled) {
+    return;
+  }
+
+  twi_poll();
+
+  // The previous reading is still in progress
+  if (!twi_txn_is_finished(&compass_txn)) {
+    return;
+  }
+
+  if (compass_txn.status == Twi_Done) {
+    statevars.compass_bus_us = compass_txn.bus_ticks * TIMEBASE_US_PER_TICK;
+
+    add_sample(compass_txn.finished_at);
+
+    if (sample_count == COMPASS_AVG_SAMPLES) {
+      save_average();
+    }
+  }
+
+  // Failed readings are counted by the TWI master in statevars.twi_*
+
+  // If the queue is full, the reading is tried again next time. Until then
+  // the old reading must not count as a new sample, so it is marked as never
+  // having been read
+  if (!twi_submit(&compass_txn)) {
+    compass_txn.status = Twi_Idle;
+  }
+
+  return;
+}
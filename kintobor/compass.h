@@ -0,0 +1,79 @@
+/*
+ * file: compass.h
+ * created: 20160906
+ * author(s): mr-augustine
+ *
+ * Lists the functions used to initialize and update the compass sensor.
+ *
+ * The driver supports the CMPS10 and the CMPS11. Both share the I2C address
+ * and the layout of the heading, pitch, and roll registers, but their raw
+ * sensor registers are in different places. Select the part with
+ * COMPASS_MODEL (in the sketch's kintobor_config.h, or below); its register map
+ * and value formats are then fixed at compile time, so nothing for the other
+ * part ends up in the program.
+ *
+ * The extern "C" construct allows the main Arduino program to use the
+ * functions declared below.
+ */
+#ifndef _COMPASS_H_
+#define _COMPASS_H_
+
+#include <stdint.h>
+
+#include "kintobor_features.h"
+
+#define COMPASS_CMPS10        10
+#define COMPASS_CMPS11        11
+
+#ifndef COMPASS_MODEL
+#define COMPASS_MODEL         COMPASS_CMPS10
+#endif
+
+// Registers and formats shared by both parts
+#define COMPASS_ADDR          0x60
+#define COMPASS_HEADING_REG   2     // 16 bits, MSB first
+#define COMPASS_HEADING_SCALE 10    // tenths of a degree per degree
+#define COMPASS_PITCH_REG     4     // signed degrees; +/- 85 on the CMPS10
+#define COMPASS_ROLL_REG      5     // and +/- 90 on the CMPS11
+
+/* Device traits:
+ *   COMPASS_MAG_X_REG       raw magnetometer X, Y, Z; 16 bits each, MSB first
+ *   COMPASS_ACCEL_X_REG     raw accelerometer X, Y, Z; 16 bits each, MSB first
+ */
+#if COMPASS_MODEL == COMPASS_CMPS10
+#define COMPASS_MAG_X_REG     10
+#define COMPASS_ACCEL_X_REG   16
+#elif COMPASS_MODEL == COMPASS_CMPS11
+#define COMPASS_MAG_X_REG     6
+#define COMPASS_ACCEL_X_REG   12
+#else
+#error "COMPASS_MODEL must be COMPASS_CMPS10 or COMPASS_CMPS11"
+#endif
+
+// Set to 1 to also read the raw magnetometer and accelerometer registers in
+// the same burst as the heading, pitch, and roll
+#ifndef COMPASS_READ_RAW
+#define COMPASS_READ_RAW      1
+#endif
+
+// Number of samples averaged into every value saved to statevars
+#define COMPASS_AVG_SAMPLES   2
+
+// Set to 1 to correct the heading with the table in compass_lut.h, which is
+// generated from a calibration spin by tools/compass_fit.py. Until a spin has
+// been fit there is no table, and the heading is left as it is either way
+#ifndef COMPASS_CORRECT_HEADING
+#define COMPASS_CORRECT_HEADING 1
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif // #ifdef __cplusplus
+  uint8_t compass_init(void);
+
+  void compass_update_all(void);
+#ifdef __cplusplus
+}
+#endif // #ifdef __cplusplus
+
+#endif // #ifndef _COMPASS_H_
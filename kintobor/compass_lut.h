@@ -0,0 +1,18 @@
+/*
+ * file: compass_lut.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Heading corrections for compass.c, generated by tools/compass_fit.py.
+ * Entry i is the correction (in tenths of a degree) to add to a heading
+ * of i degrees; headings in between are interpolated.
+ *
+ * No calibration has been applied, so there is no table and headings
+ * are left as the compass reports them.
+ */
+#ifndef _COMPASS_LUT_H_
+#define _COMPASS_LUT_H_
+
+#define COMPASS_LUT_CALIBRATED 0
+
+#endif // #ifndef _COMPASS_LUT_H_
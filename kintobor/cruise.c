@@ -0,0 +1,129 @@
+/*
+ * file: cruise.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Defines the forward speed (cruise) controller. The throttle is the sum of:
+ *  - a feed-forward term interpolated from the calibration table below,
+ *  - a proportional term on the speed error, and
+ *  - an integral term on the speed error.
+ *
+ * The integral is clamped to CRUISE_MAX_TRIM_US and stops accumulating while
+ * the throttle is saturated so that it can't wind up when the robot is held
+ * back (e.g., by a slope it can't climb).
+ */
+#include "cruise.h"
+#include "mobility.h"
+#include "statevars.h"
+
+#define MS_PER_SEC            1000
+#define CRUISE_MAX_DT_MS      100     // longer gaps are treated as 100 ms
+
+typedef struct {
+  uint16_t speed_mmps;
+  uint16_t throttle_us;
+} cruise_calibration_t;
+
+/* Steady-state throttle needed to hold each speed on flat ground with a fully
+ * charged battery. Speeds must be increasing; the table is interpolated
+ * linearly between entries and held at the last entry beyond the end.
+ */
+static const cruise_calibration_t calibration[] = {
+  {    0, SPEED_NEUTRAL },
+  {  300, 1560 },
+  { 1000, 1630 },
+  { 2000, 1720 },
+  { 3000, 1820 },
+  { 4500, CRUISE_THROTTLE_MAX_US }
+};
+
+#define CALIBRATION_ENTRIES (sizeof(calibration) / sizeof(calibration[0]))
+
+// Integral term in microseconds << CRUISE_GAIN_FRAC_BITS
+static int32_t integral;
+
+static uint16_t feedforward_us(uint16_t target_mmps);
+
+// Looks up the steady-state throttle for the target speed
+static uint16_t feedforward_us(uint16_t target_mmps) {
+  uint8_t i;
+  for (i = 1; i < CALIBRATION_ENTRIES; i++) {
+    if (target_mmps <= calibration[i].speed_mmps) {
+      const cruise_calibration_t * lo = &calibration[i - 1];
+      const cruise_calibration_t * hi = &calibration[i];
+
+      return lo->throttle_us +
+          (uint32_t) (target_mmps - lo->speed_mmps) *
+          (hi->throttle_us - lo->throttle_us) /
+          (hi->speed_mmps - lo->speed_mmps);
+    }
+  }
+
+  return calibration[CALIBRATION_ENTRIES - 1].throttle_us;
+}
+
+void cruise_init(void) {
+  integral = 0;
+
+  statevars.cruise_target_mmps = 0;
+  statevars.cruise_error_mmps = 0;
+  statevars.cruise_feedforward_us = SPEED_NEUTRAL;
+  statevars.cruise_integral_us = 0;
+
+  return;
+}
+
+/* Advances the controller by dt_ms and returns the throttle pulse width that
+ * should hold the target speed. A target of zero returns neutral and clears
+ * the integral so that the next start doesn't inherit an old trim.
+ */
+uint16_t cruise_update(uint16_t target_mmps, uint16_t speed_mmps, uint16_t dt_ms) {
+  int32_t error = (int32_t) target_mmps - speed_mmps;
+  uint16_t feedforward = feedforward_us(target_mmps);
+
+  if (dt_ms > CRUISE_MAX_DT_MS) {
+    dt_ms = CRUISE_MAX_DT_MS;
+  }
+
+  if (target_mmps == 0) {
+    integral = 0;
+    feedforward = SPEED_NEUTRAL;
+    error = 0;
+  }
+
+  int32_t integral_step = CRUISE_KI * error * dt_ms / MS_PER_SEC;
+  int32_t integral_limit = (int32_t) CRUISE_MAX_TRIM_US << CRUISE_GAIN_FRAC_BITS;
+  int32_t previous_integral = integral;
+
+  integral += integral_step;
+
+  if (integral > integral_limit) {
+    integral = integral_limit;
+  } else if (integral < -integral_limit) {
+    integral = -integral_limit;
+  }
+
+  int32_t throttle = feedforward +
+      (CRUISE_KP * error + integral) / (1 << CRUISE_GAIN_FRAC_BITS);
+
+  // Don't let the integral wind up while the throttle is saturated
+  if (throttle > CRUISE_THROTTLE_MAX_US) {
+    throttle = CRUISE_THROTTLE_MAX_US;
+    if (integral_step > 0) {
+      integral = previous_integral;
+    }
+  } else if (throttle < SPEED_NEUTRAL) {
+    throttle = SPEED_NEUTRAL;
+    if (integral_step < 0) {
+      integral = previous_integral;
+    }
+  }
+
+  statevars.cruise_target_mmps = target_mmps;
+  statevars.cruise_error_mmps = (error > INT16_MAX) ? INT16_MAX :
+      (error < INT16_MIN) ? INT16_MIN : error;
+  statevars.cruise_feedforward_us = feedforward;
+  statevars.cruise_integral_us = integral / (1 << CRUISE_GAIN_FRAC_BITS);
+
+  return throttle;
+}
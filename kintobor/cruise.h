@@ -0,0 +1,39 @@
+/*
+ * file: cruise.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Lists the functions used by the forward speed (cruise) controller. The
+ * controller turns a target speed in millimeters per second into a throttle
+ * pulse width. A feed-forward value looked up from a calibration table gets
+ * the throttle close to the right value, and a PI loop on the odometer speed
+ * trims out what the table gets wrong (battery voltage, terrain, etc.).
+ *
+ * The gains are fixed point with CRUISE_GAIN_FRAC_BITS fractional bits, so a
+ * gain of 256 means one microsecond of throttle per millimeter per second of
+ * error (or per millimeter of accumulated error for the integral gain).
+ *
+ * The extern "C" construct allows the main Arduino program to use the
+ * functions declared below.
+ */
+#ifndef _CRUISE_H_
+#define _CRUISE_H_
+
+#include <stdint.h>
+
+#define CRUISE_GAIN_FRAC_BITS   8
+#define CRUISE_KP               13      // ~0.05 us per mm/s of error
+#define CRUISE_KI               26      // ~0.1 us per mm of accumulated error
+#define CRUISE_MAX_TRIM_US      100     // limit on the integral term
+#define CRUISE_THROTTLE_MAX_US  2000    // full forward throttle
+
+#ifdef __cplusplus
+extern "C" {
+#endif // #ifdef __cplusplus
+  void cruise_init(void);
+  uint16_t cruise_update(uint16_t target_mmps, uint16_t speed_mmps, uint16_t dt_ms);
+#ifdef __cplusplus
+}
+#endif // #ifdef __cplusplus
+
+#endif // #ifndef _CRUISE_H_
@@ -0,0 +1,26 @@
+/*
+ * file: hal.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Selects the hardware definitions (registers, bit names, ISR(), cli(), sei(),
+ * and PROGMEM) that every driver uses. Drivers include this header instead of
+ * the avr-libc headers.
+ *
+ * On the robot these are avr-libc's own definitions, so nothing changes in the
+ * program. When KINTOBOR_HOST is defined, hal_host.h (see tools/host) supplies
+ * simulated registers and peripherals instead, so the same drivers, parsers,
+ * and navigation code can be compiled and run on a Linux machine.
+ */
+#ifndef _HAL_H_
+#define _HAL_H_
+
+#ifdef KINTOBOR_HOST
+#include "hal_host.h"
+#else
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#endif // #ifdef KINTOBOR_HOST
+
+#endif // #ifndef _HAL_H_
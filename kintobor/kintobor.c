@@ -0,0 +1,572 @@
+/*
+ * file: kintobor.c
+ * created: 20160906
+ * author(s): mr-augustine
+ *
+ * The kintobor implementation file defines all of the robot's higher-order
+ * functions. The navigation (KINTOBOR_WITH_NAV) and heading control
+ * (KINTOBOR_WITH_CONTROL) code is only built into sketches that select it; see
+ * kintobor_features.h.
+ *
+ * This implementation uses the zeroized-whole-degree method in an effort to
+ * generate more precise navigation-related values. This mod hopes to address
+ * the seemingly insufficient precision given by the float datatype when used
+ * to represent the calculated GPS coordinates between measured GPS coordinates.
+ */
+#include "kintobor.h"
+#include <math.h>
+
+#define DEG_TO_RAD(degrees) (degrees * M_PI / 180.0)
+#define RAD_TO_DEG(radians) (radians * 180.0 / M_PI)
+#define EARTH_RADIUS_M 6371393.0
+// Stolen from NOAA: https://www.ngdc.noaa.gov/geomag/WMM/data/WMM2015/WMM2015_D_MERC.pdf
+// And stolen from NGDC: http://www.ngdc.noaa.gov/geomag-web/
+// A sketch run somewhere else sets its own in its kintobor_config.h
+#ifndef MAGNETIC_DECLINATION
+#define MAGNETIC_DECLINATION 8.52  // For Boulder, Colorado
+#endif
+#define METERS_PER_SECOND_PER_KNOT 0.514444
+
+// The tuning values below can be overridden from the compiler's command line
+// (e.g., -DK_PROP=2.0), which is how tools/sweep.py tries them out
+#ifndef TICKS_PER_METER
+#define TICKS_PER_METER 7.6
+#endif
+
+// The compass heading is ignored once it's older than this, and a GPS fix is
+// never moved forward by more than this much time
+#define COMPASS_MAX_AGE_TICKS (100UL * TIMEBASE_TICKS_PER_MS)
+#define GPS_MAX_EXTRAPOLATION_TICKS (1000UL * TIMEBASE_TICKS_PER_MS)
+#define SECONDS_PER_TIMEBASE_TICK (TIMEBASE_US_PER_TICK / 1000000.0)
+
+#define SECONDS_PER_LOOP (CONTROL_PERIOD_FRAMES * SCHED_FRAME_MS / 1000.0)
+
+#define TARGET_HEADING 270.0
+
+#ifndef K_PROP
+#define K_PROP 2.7777777777777 // proportional gain
+#endif
+#ifndef K_RATE
+#define K_RATE 0 // derivative gain
+#endif
+#ifndef K_INTEGRAL
+#define K_INTEGRAL 0 // integral gain
+#endif
+
+// How calc_nav_heading() combines the compass and GPS headings
+#define NAV_HEADING_COMPASS 0   // the compass alone
+#define NAV_HEADING_MID_ANGLE 1 // halfway between the compass and the GPS
+
+#ifndef NAV_HEADING_BLEND
+#define NAV_HEADING_BLEND NAV_HEADING_MID_ANGLE
+#endif
+
+#if KINTOBOR_WITH_NAV || KINTOBOR_WITH_CONTROL
+static float calc_compass_heading(void);
+static float calc_relative_bearing(float desired_bearing, float current_heading);
+#endif
+
+#if KINTOBOR_WITH_NAV
+static float current_lat;
+static float current_long;
+static float waypoint_lat;
+static float waypoint_long;
+static float nav_heading_deg;
+static float rel_bearing_deg;
+static float distance_to_waypoint_m;
+static float current_speed; // in meters per second
+static float waypt_true_bearing;
+
+static float gps_lat_most_recent;
+static float gps_long_most_recent;
+static float gps_hdg_most_recent;
+static float gps_speed_most_recent; // in meters per second
+static uint32_t prev_tick_count;
+
+static float calc_dist_to_waypoint(float start_lat, float start_long, float end_lat, float end_long);
+static float calc_mid_angle(float heading_1, float heading_2);
+static float calc_nav_heading(uint32_t now);
+static void calc_position(float* new_lat, float* new_long, float ref_lat, float ref_long, float distance, float heading);
+static float calc_speed_mps(void);
+static float calc_true_bearing(float start_lat, float start_long, float dest_lat, float dest_long);
+static void get_next_waypoint(void);
+
+static uint8_t got_first_coord = 0;
+#endif // #if KINTOBOR_WITH_NAV
+
+#if KINTOBOR_WITH_CONTROL
+static void update_xtrack_error(void);
+static void update_xtrack_error_rate(void);
+static void update_xtrack_error_sum(void);
+
+static float xtrack_error;
+static float xtrack_error_prev;
+static float xtrack_error_rate;
+static float xtrack_error_sum;
+
+static float steer_control = 1500;
+#endif // #if KINTOBOR_WITH_CONTROL
+
+#if KINTOBOR_WITH_NAV || KINTOBOR_WITH_CONTROL
+// Returns the compass heading corrected to a true heading
+static float calc_compass_heading(void) {
+  float norm_mag_hdg = statevars.heading_deg + MAGNETIC_DECLINATION;
+
+  if (norm_mag_hdg > 360.0) {
+    norm_mag_hdg -= 360.0;
+  }
+
+  return norm_mag_hdg;
+}
+
+// Calculates the relative bearing in degrees (i.e., the angle between the current
+// heading and the waypoint bearing); a negative value means the destination
+// is towards the left, and vice versa
+// "I'd have to change my heading by this much to point to the waypoint"
+static float calc_relative_bearing(float desired_bearing, float current_heading) {
+  float diff = desired_bearing - current_heading;
+
+  // We want the range of bearings to be between -180..+180; so a result of
+  // -225 (225 degrees to the left of where I'm pointing) will become +135
+  // (135 degrees to the right of where I'm pointing)
+  if (diff > 180.0) {
+    return (diff - 360.0);
+  } else if (diff < -180.0) {
+    return (diff + 360.0);
+  }
+
+  return diff;
+}
+#endif // #if KINTOBOR_WITH_NAV || KINTOBOR_WITH_CONTROL
+
+#if KINTOBOR_WITH_NAV
+// Returns the distance (in meters) to the current waypoint
+static float calc_dist_to_waypoint(float lat_1, float long_1, float lat_2, float long_2) {
+  float lat_1_rad = DEG_TO_RAD(lat_1);
+  float long_1_rad = DEG_TO_RAD(long_1);
+  float lat_2_rad = DEG_TO_RAD(lat_2);
+  float long_2_rad = DEG_TO_RAD(long_2);
+
+  float diff_lat = lat_2_rad - lat_1_rad;
+  float diff_long = long_2_rad - long_1_rad;
+
+  float a = ( pow(sin(diff_lat / 2), 2) ) +
+    cos(lat_1_rad) *
+    cos(lat_2_rad) *
+    ( pow(sin(diff_long / 2), 2) );
+
+  float c = 2 * asin(sqrt(a));
+
+  float distance_m = EARTH_RADIUS_M * c;
+
+  return distance_m;
+}
+
+// Returns the angle that is halfway between the specified headings
+static float calc_mid_angle(float heading_1, float heading_2) {
+  // Ensure that heading_2 stores the larger heading
+  if (heading_1 > heading_2) {
+    float temp = heading_1;
+    heading_1 = heading_2;
+    heading_2 = temp;
+  }
+
+  if (heading_2 - heading_1 > 180.0) {
+    heading_2 -= 360.0;
+  }
+
+  float mid_angle = (heading_2 + heading_1) / 2.0;
+
+  if (mid_angle < 0.0) {
+    mid_angle += 360.0;
+  }
+
+  return mid_angle;
+}
+
+static float calc_nav_heading(uint32_t now) {
+  // A compass that stopped answering would hold the heading where it was
+  if (!sample_is_fresh(&statevars.compass_meta, now, COMPASS_MAX_AGE_TICKS)) {
+    return gps_hdg_most_recent;
+  }
+
+  float norm_mag_hdg = calc_compass_heading();
+
+  if (NAV_HEADING_BLEND == NAV_HEADING_COMPASS) {
+    return norm_mag_hdg;
+  }
+
+  // Here we're calculating the navigation heading as the mid-angle between
+  // the compass heading and the GPS heading because experimental data seemed
+  // to produce good results when we did this.
+  float nav_heading = calc_mid_angle(norm_mag_hdg, gps_hdg_most_recent);
+
+  return nav_heading;
+}
+
+// Calculates a new position based on the current heading and distance
+// traveled from the previous position
+static void calc_position(float* new_lat, float* new_long, float ref_lat, float ref_long, float distance, float heading) {
+  float lat_rad = DEG_TO_RAD(ref_lat);
+  float long_rad = DEG_TO_RAD(ref_long);
+  float heading_rad = DEG_TO_RAD(heading);
+
+  float est_lat = asin( sin(lat_rad) *
+    cos(distance / EARTH_RADIUS_M) +
+    cos(lat_rad) *
+    sin(distance / EARTH_RADIUS_M) *
+    cos(heading_rad) );
+
+  float est_long = long_rad +
+    atan2( sin(heading_rad) *
+    sin(distance / EARTH_RADIUS_M) *
+    cos(lat_rad),
+    cos(distance / EARTH_RADIUS_M) -
+    sin(lat_rad) *
+    sin(est_lat) );
+
+  *new_lat = RAD_TO_DEG(est_lat);
+  *new_long = RAD_TO_DEG(est_long);
+
+  return;
+}
+
+// Calculate the robot's current speed from the period between the two most
+// recent odometer ticks; result is in meters per second
+static float calc_speed_mps(void) {
+  return statevars.odometer_speed_mmps / 1000.0;
+}
+
+// Calculates the true bearing between two gps coordinates in degrees
+// "I'd have to change my heading to this value to point to that coordinate"
+static float calc_true_bearing(float start_lat, float start_long, float dest_lat, float dest_long) {
+  float start_lat_rad = DEG_TO_RAD(start_lat);
+  float start_long_rad = DEG_TO_RAD(start_long);
+  float dest_lat_rad = DEG_TO_RAD(dest_lat);
+  float dest_long_rad = DEG_TO_RAD(dest_long);
+
+  float y = sin(dest_long_rad - start_long_rad) *
+    cos(dest_lat_rad);
+  float x = cos(start_lat_rad) *
+    sin(dest_lat_rad) -
+    sin(start_lat_rad) *
+    cos(dest_lat_rad) *
+    cos(dest_long_rad - start_long_rad);
+
+  float bearing_rad = atan2(y, x);
+  float bearing_deg = RAD_TO_DEG(bearing_rad);
+
+  // Shift the values from the range [-180,180] to [0,360)
+  if (bearing_deg < 0.0) {
+    return bearing_deg + 360.0;
+  }
+
+  return bearing_deg;
+}
+
+// Gets the next waypoint
+// For this demo, we're using the decimal degrees of the first GPS coordinate
+// we received
+static void get_next_waypoint(void) {
+  if (got_first_coord == 1) {
+    return;
+  }
+
+  if (statevars.status & STATUS_GPS_FIX_AVAIL) {
+    // Ensure we aren't getting the default lat/long
+    //TODO We're assuming that the waypoint and current position don't cross
+    //a whole degree boundary!!! Fix this!
+    if (statevars.gps_latitude != 0.0 && statevars.gps_longitude != 0.0) {
+      waypoint_lat = statevars.gps_lat_ddeg;
+      waypoint_long = statevars.gps_long_ddeg;
+
+      got_first_coord = 1;
+    }
+  }
+
+  return;
+}
+
+void update_all_nav(void) {
+  uint32_t now = timebase_now();
+  uint8_t got_new_fix = 0;
+
+  get_next_waypoint();
+
+  // Check if a new GPS coordinate was received and update the position
+  if (statevars.status & STATUS_GPS_FIX_AVAIL) {
+    got_new_fix = 1;
+
+    // Calculate a new gps-based heading using the previous coord (current)
+    // and the newest coord (statevars)
+    gps_hdg_most_recent = calc_true_bearing(gps_lat_most_recent,
+                                            gps_long_most_recent,
+                                            statevars.gps_lat_ddeg,
+                                            statevars.gps_long_ddeg);
+
+    gps_lat_most_recent = statevars.gps_lat_ddeg;
+    gps_long_most_recent = statevars.gps_long_ddeg;
+    current_lat = statevars.gps_lat_ddeg;
+    current_long = statevars.gps_long_ddeg;
+  }
+
+  // Check if a new GPS heading and speed were received and update
+  if (statevars.status & STATUS_GPS_GPRMC_RCVD) {
+    // Not using the gps heading because sometimes it's horrendous. Instead,
+    // we'll calculate our own using calc_true_bearing()
+    // gps_hdg_most_recent = statevars.gps_ground_course_deg;
+    gps_speed_most_recent = statevars.gps_ground_speed_kt * METERS_PER_SECOND_PER_KNOT;
+  }
+
+  // Calculate the number of ticks that occurred during the current iteration
+  // Since the tick count is cumulative, the new tick count will always be
+  // greater-than or equal to the previous tick count
+  uint32_t new_tick_count = statevars.odometer_ticks;
+  uint32_t tick_diff = new_tick_count - prev_tick_count;
+
+  current_speed = calc_speed_mps();
+
+  float distance_since_prev_iter_m = tick_diff / TICKS_PER_METER;
+
+  // Advance the tick count now that we're done with the previous value
+  prev_tick_count = new_tick_count;
+
+  if (current_speed == 0.0) {
+    current_speed = gps_speed_most_recent;
+  }
+
+  nav_heading_deg = calc_nav_heading(now);
+
+  // A new fix tells where we were when it was measured, so move it forward by
+  // the distance driven since then. That distance includes this iteration's
+  // ticks.
+  if (got_new_fix) {
+    uint32_t fix_age = sample_age(&statevars.gps_meta, now);
+
+    if (fix_age > GPS_MAX_EXTRAPOLATION_TICKS) {
+      fix_age = GPS_MAX_EXTRAPOLATION_TICKS;
+    }
+
+    distance_since_prev_iter_m = current_speed * fix_age *
+        SECONDS_PER_TIMEBASE_TICK;
+  }
+
+  float old_lat = current_lat;
+  float old_long = current_long;
+  calc_position(&current_lat, &current_long, old_lat, old_long, distance_since_prev_iter_m, nav_heading_deg);
+
+  waypt_true_bearing = calc_true_bearing(current_lat, current_long, waypoint_lat, waypoint_long);
+  rel_bearing_deg = calc_relative_bearing(waypt_true_bearing, nav_heading_deg);
+
+  distance_to_waypoint_m = calc_dist_to_waypoint(current_lat, current_long, waypoint_lat, waypoint_long);
+
+  statevars.nav_timestamp = now;
+  statevars.nav_heading_deg = nav_heading_deg;
+  statevars.nav_gps_heading = gps_hdg_most_recent;
+  statevars.nav_latitude = current_lat;
+  statevars.nav_longitude = current_long;
+  statevars.nav_waypt_latitude = waypoint_lat;
+  statevars.nav_waypt_longitude = waypoint_long;
+  statevars.nav_rel_bearing_deg = rel_bearing_deg;
+  statevars.nav_distance_to_waypt_m = distance_to_waypoint_m;
+  statevars.nav_speed = current_speed;
+
+  return;
+}
+#endif // #if KINTOBOR_WITH_NAV
+
+#if KINTOBOR_WITH_CONTROL
+static void update_xtrack_error(void) {
+  // Error = Reference Value - Measured value
+  xtrack_error_prev = xtrack_error;
+
+#if KINTOBOR_WITH_NAV
+  float heading_deg = nav_heading_deg;
+#else
+  // Without navigation, steer by the compass alone
+  float heading_deg = calc_compass_heading();
+#endif
+
+  xtrack_error = calc_relative_bearing(TARGET_HEADING, heading_deg);
+
+  // TODO Change this assignment when you start navigating to waypoints.
+  // Normally the desired heading will be the waypt_true_bearing unless we set
+  // a new bearing if an obstacle is detected
+  statevars.control_heading_desired = TARGET_HEADING;
+  // statevars.control_heading_desired = waypt_true_bearing;
+
+  statevars.control_xtrack_error = xtrack_error;
+  // TODO Normally the cross track error will be the relative bearing (to the
+  // waypoint) unless we decide to set a new bearing if an obstacle is detected
+  // statevars.control_xtrack_error = rel_bearing_deg;
+
+  return;
+}
+
+static void update_xtrack_error_rate(void) {
+  // Rate = (Error - Error_Previous) / Computation Interval
+  xtrack_error_rate = (xtrack_error - xtrack_error_prev) / SECONDS_PER_LOOP;
+
+  statevars.control_xtrack_error_rate = xtrack_error_rate;
+
+  return;
+}
+
+static void update_xtrack_error_sum(void) {
+  // Rate Sum = Rate Sum + Error * Computation Interval
+  xtrack_error_sum = xtrack_error_sum + xtrack_error * SECONDS_PER_LOOP;
+
+  statevars.control_xtrack_error_sum = xtrack_error_sum;
+
+  return;
+}
+
+#endif // #if KINTOBOR_WITH_CONTROL
+
+#if KINTOBOR_WITH_BUTTON
+static uint8_t button_start(void) {
+  if (!button_init()) {
+    return 0;
+  }
+
+  led_turn_off();
+
+  return 1;
+}
+#endif
+
+#if KINTOBOR_WITH_COMPASS
+static uint8_t compass_start(void) {
+  return twi_init(TWI_FREQ_FAST) && compass_init();
+}
+
+// The compass is ready once it has answered enough readings for an average
+static uint8_t compass_poll(void) {
+  compass_update_all();
+
+  return statevars.compass_meta.valid;
+}
+#endif
+
+#if KINTOBOR_WITH_GPS
+// The receiver is ready once a whole GPGGA sentence came through; it doesn't
+// need a fix yet
+static uint8_t gps_poll(void) {
+  gps_update();
+
+  return (statevars.gps_meta.seq != 0);
+}
+#endif
+
+/* The boot steps of every feature the sketch is built with. The ESC takes the
+ * longest to become ready, so it's started first. The GPS is optional: a
+ * receiver that hasn't sent a GPGGA sentence by the timeout (e.g., indoors,
+ * or with its antenna unplugged) is reported, but the sketch still runs, and
+ * navigation uses its position once the sentences arrive.
+ */
+static const boot_step_t core_boot_steps[] = {
+  // name           start           poll                optional
+#if KINTOBOR_WITH_MOBILITY
+  { "Mobility",     mobility_init,  mobility_is_armed,  0 },
+#endif
+#if KINTOBOR_WITH_BUTTON
+  { "LED button",   button_start,   NULL,               0 },
+#endif
+#if KINTOBOR_WITH_COMPASS
+  { "Compass",      compass_start,  compass_poll,       0 },
+#endif
+#if KINTOBOR_WITH_GPS
+  { "GPS sensor",   gps_init,       gps_poll,           1 },
+#endif
+#if KINTOBOR_WITH_ODOMETER
+  { "Odometer",     odometer_init,  NULL,               0 },
+#endif
+};
+
+#define NUM_CORE_BOOT_STEPS \
+    (sizeof(core_boot_steps) / sizeof(core_boot_steps[0]))
+
+/* Initializes the drivers of every feature the sketch is built with without
+ * waiting for any of them to become ready (e.g., for the ESC to arm).
+ * Returns 1 if all of them started; 0 otherwise
+ */
+uint8_t init_all_subsystems(void) {
+  uwrite_init();
+
+  // The drivers timestamp their samples against the timebase
+  timebase_init();
+
+  boot_begin();
+
+  return boot_start(core_boot_steps, NUM_CORE_BOOT_STEPS);
+}
+
+/* Starts every feature the sketch is built with, followed by the sketch's own
+ * boot steps (e.g., the SD card), and waits until all of them are ready. Then
+ * reports how long each one took on the serial port.
+ * Returns 1 if all of them are ready; 0 otherwise
+ */
+uint8_t boot_all_subsystems(const boot_step_t * sketch_steps,
+                            uint8_t num_sketch_steps) {
+  uint8_t started = init_all_subsystems();
+
+  if (sketch_steps != NULL &&
+      !boot_start(sketch_steps, num_sketch_steps)) {
+    started = 0;
+  }
+
+  uint8_t ready = boot_wait(BOOT_TIMEOUT_MS);
+  boot_report();
+
+  return started && ready;
+}
+
+void update_all_inputs(void) {
+#if KINTOBOR_WITH_BUTTON
+  button_update();
+#endif
+#if KINTOBOR_WITH_COMPASS
+  compass_update_all();
+#endif
+#if KINTOBOR_WITH_GPS
+  gps_update();
+#endif
+#if KINTOBOR_WITH_ODOMETER
+  odometer_update();
+#endif
+
+#if KINTOBOR_WITH_NAV
+  update_all_nav();
+#endif
+
+  return;
+}
+
+#if KINTOBOR_WITH_CONTROL
+void update_nav_control_values(void) {
+  update_xtrack_error();
+  update_xtrack_error_rate();
+  update_xtrack_error_sum();
+
+  steer_control = (K_PROP * xtrack_error) +
+                  (K_RATE * xtrack_error_rate) +
+                  (K_INTEGRAL * xtrack_error_sum);
+
+  // A positive error means the target is to the right, and pulses narrower
+  // than neutral steer right
+  float steer_pwm = TURN_NEUTRAL - steer_control;
+
+  // Keep the pulse within the full left/right steering angles. This has to
+  // happen before the cast: a large gain and a large error can ask for a
+  // negative pulse, which doesn't convert to a uint16_t
+  if (steer_pwm < TURN_FULL_RIGHT) {
+    steer_pwm = TURN_FULL_RIGHT;
+  } else if (steer_pwm > TURN_FULL_LEFT) {
+    steer_pwm = TURN_FULL_LEFT;
+  }
+
+  statevars.control_steering_pwm = (uint16_t) steer_pwm;
+
+  return;
+}
+#endif // #if KINTOBOR_WITH_CONTROL
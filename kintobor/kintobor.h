@@ -0,0 +1,70 @@
+/*
+ * file: kintobor.h
+ * created: 20160906
+ * author(s): mr-augustine
+ *
+ * The kintobor header file lists function prototypes for all of the robot's
+ * higher-order functions. Only the functions of the features that the sketch
+ * is built with (see kintobor_features.h) are declared.
+ */
+#ifndef _KINTOBOR_H_
+#define _KINTOBOR_H
+
+#include "boot.h"
+#include "kintobor_features.h"
+#include "ram.h"
+#include "sample.h"
+#include "scheduler.h"
+#include "statevars.h"
+#include "timebase.h"
+#include "uwrite.h"
+
+#if KINTOBOR_WITH_BUTTON
+#include "ledbutton.h"
+#endif
+#if KINTOBOR_WITH_GPS
+#include "gps.h"
+#endif
+#if KINTOBOR_WITH_COMPASS
+#include "compass.h"
+#include "twi_master.h"
+#endif
+#if KINTOBOR_WITH_ODOMETER
+#include "odometer.h"
+#endif
+#if KINTOBOR_WITH_MOBILITY
+#include "mobility.h"
+#endif
+#if KINTOBOR_WITH_PUBLISH
+#include "publish.h"
+#endif
+#if KINTOBOR_WITH_MISSION
+#include "mission.h"
+#endif
+
+#define ROBOT_NAME ("kintobor")
+
+// The navigation control values are recalculated every other frame (50 Hz),
+// right after update_all_nav() has refreshed the heading. Running them more
+// often than the heading changes would make the error rate and sum see every
+// heading twice.
+#define CONTROL_PERIOD_FRAMES 2
+
+#ifdef __cplusplus
+extern "C" {
+#endif // #ifdef __cplusplus
+  uint8_t init_all_subsystems(void);
+  uint8_t boot_all_subsystems(const boot_step_t * sketch_steps,
+                              uint8_t num_sketch_steps);
+  void update_all_inputs(void);
+#if KINTOBOR_WITH_NAV
+  void update_all_nav(void);
+#endif
+#if KINTOBOR_WITH_CONTROL
+  void update_nav_control_values(void);
+#endif
+#ifdef __cplusplus
+}
+#endif // #ifdef __cplusplus
+
+#endif // #ifndef _KINTOBOR_H_
@@ -0,0 +1,81 @@
+/*
+ * file: kintobor_features.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Selects the parts of the kintobor core that a sketch is built with.
+ *
+ * Every sketch keeps a kintobor_config.h next to its .ino file. The config
+ * sets a KINTOBOR_WITH_* switch to 1 for each feature the sketch uses, and it
+ * can also pick the compass model (COMPASS_MODEL) and override the navigation
+ * and control tuning values (NAV_HEADING_BLEND, K_PROP, etc.). A feature that
+ * the config doesn't mention is left out, except that publishing is on
+ * whenever the SD card is.
+ *
+ * The statevars fields, the kintobor.c code, and the initialization of a
+ * feature that is left out are compiled out. A sketch only links to the core
+ * files of the features it uses (see README.md), so the drivers, and the ISRs
+ * they contain, of every other feature aren't built at all.
+ */
+#ifndef _KINTOBOR_FEATURES_H_
+#define _KINTOBOR_FEATURES_H_
+
+#include "kintobor_config.h"
+
+#ifndef KINTOBOR_WITH_BUTTON
+#define KINTOBOR_WITH_BUTTON    0   // start/stop button and its LED
+#endif
+#ifndef KINTOBOR_WITH_GPS
+#define KINTOBOR_WITH_GPS       0   // GPS receiver on USART2
+#endif
+#ifndef KINTOBOR_WITH_COMPASS
+#define KINTOBOR_WITH_COMPASS   0   // CMPS10/CMPS11 compass on the TWI bus
+#endif
+#ifndef KINTOBOR_WITH_ODOMETER
+#define KINTOBOR_WITH_ODOMETER  0   // wheel odometer on Timer5's ICP
+#endif
+#ifndef KINTOBOR_WITH_MOBILITY
+#define KINTOBOR_WITH_MOBILITY  0   // steering servo and ESC on Timer3
+#endif
+#ifndef KINTOBOR_WITH_SDCARD
+#define KINTOBOR_WITH_SDCARD    0   // statevars log on the SD card (sdcard.ino)
+#endif
+#ifndef KINTOBOR_WITH_PUBLISH
+// Complete statevars records for the SD card and other consumers (publish.c)
+#define KINTOBOR_WITH_PUBLISH   KINTOBOR_WITH_SDCARD
+#endif
+#ifndef KINTOBOR_WITH_NAV
+#define KINTOBOR_WITH_NAV       0   // position estimates and the waypoint
+#endif
+#ifndef KINTOBOR_WITH_CONTROL
+#define KINTOBOR_WITH_CONTROL   0   // steering towards a target heading
+#endif
+#ifndef KINTOBOR_WITH_MISSION
+#define KINTOBOR_WITH_MISSION   0   // the timed drive of demo_sgconzm
+#endif
+
+// Navigation needs a position (GPS), a heading (compass), and the distance
+// driven (odometer)
+#if KINTOBOR_WITH_NAV && \
+    !(KINTOBOR_WITH_GPS && KINTOBOR_WITH_COMPASS && KINTOBOR_WITH_ODOMETER)
+#error "KINTOBOR_WITH_NAV needs the GPS, compass, and odometer"
+#endif
+
+// The SD card logs the published records
+#if KINTOBOR_WITH_SDCARD && !KINTOBOR_WITH_PUBLISH
+#error "KINTOBOR_WITH_SDCARD needs KINTOBOR_WITH_PUBLISH"
+#endif
+
+// The controller steers by the compass heading when there is no navigation
+#if KINTOBOR_WITH_CONTROL && \
+    !(KINTOBOR_WITH_COMPASS && KINTOBOR_WITH_MOBILITY)
+#error "KINTOBOR_WITH_CONTROL needs the compass and mobility"
+#endif
+
+// The mission's task table runs every one of these
+#if KINTOBOR_WITH_MISSION && \
+    !(KINTOBOR_WITH_BUTTON && KINTOBOR_WITH_NAV && KINTOBOR_WITH_CONTROL)
+#error "KINTOBOR_WITH_MISSION needs the button, navigation, and control"
+#endif
+
+#endif // #ifndef _KINTOBOR_FEATURES_H_
@@ -0,0 +1,66 @@
+/*
+ * file: mission.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Defines the mission task table and the output task that drives the robot.
+ */
+#include <stdint.h>
+
+#include "kintobor.h"
+#include "mission.h"
+
+uint8_t mission_complete;
+
+static void control_output_task(void);
+
+/* The mission task table. Tasks run in the order listed, which is sorted by
+ * deadline. Frames are 10 ms long, so a period of 2 frames is 50 Hz.
+ *
+ * The GPS and navigation tasks share the even frames so that the navigation
+ * sees every new GPS fix exactly once: the log task runs in the odd frames and
+ * clears the status bits after they have been recorded. The compass is sampled
+ * every frame and publishes the average of every two samples.
+ */
+const sched_task_t mission_tasks[MISSION_NUM_TASKS] = {
+  // run                        period  offset  deadline
+  { mission_log_task,           2,      1,      4 * SCHED_TICKS_PER_MS },
+  { button_update,              10,     0,      5 * SCHED_TICKS_PER_MS },
+  { gps_update,                 10,     0,      6 * SCHED_TICKS_PER_MS },
+  { compass_update_all,         1,      0,      6 * SCHED_TICKS_PER_MS },
+  { odometer_update,            1,      0,      7 * SCHED_TICKS_PER_MS },
+  { update_all_nav,             2,      0,      9 * SCHED_TICKS_PER_MS },
+  { update_nav_control_values,  CONTROL_PERIOD_FRAMES, 0, SCHED_FRAME_TICKS },
+  { control_output_task,        2,      0,      SCHED_FRAME_TICKS }
+};
+
+/* Hands the mission task table to the scheduler.
+ * Returns 1 if the scheduler took it; 0 otherwise
+ */
+uint8_t mission_init(void) {
+  mission_complete = 0;
+
+  return sched_init(mission_tasks, MISSION_NUM_TASKS);
+}
+
+/* Updates the steering and throttle pulse widths. Timer3 generates the
+ * pulses in hardware, so this task can run anywhere in the frame; the new
+ * widths take effect at the start of the next 20 ms PWM frame. Once the
+ * mission is complete, the throttle is ramped down instead.
+ */
+static void control_output_task(void) {
+#if COMPASS_CALIBRATION_SPIN
+  mobility_steer(TURN_FULL_LEFT);
+#else
+  // The controller's pulse width, from update_nav_control_values()
+  mobility_steer(statevars.control_steering_pwm);
+#endif
+
+  if (mission_complete) {
+    mobility_stop();
+  } else {
+    mobility_drive_fwd(Speed_Creep);
+  }
+
+  return;
+}
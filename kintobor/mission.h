@@ -0,0 +1,59 @@
+/*
+ * file: mission.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Lists the mission that demo_sgconzm runs: drive towards the target heading
+ * at a creep until MISSION_TIMEOUT_FRAMES have gone by, then stop. The sketch,
+ * the simulator (tools/sim), and the latency target (tools/latency) all run
+ * this one task table, so they can't drift apart.
+ *
+ * Each program provides mission_log_task(), which records the statevars
+ * wherever that program keeps them (e.g., on the SD card) and then clears the
+ * status bits, and sets mission_complete once the mission is over; the output
+ * task then ramps the throttle down.
+ *
+ *   if (!mission_init()) ...               // after boot, before sched_start()
+ *   sched_run_frame();                     // in the main loop
+ *   if (sched_get_frame_count() > MISSION_TIMEOUT_FRAMES) {
+ *     mission_complete = 1;
+ *   }
+ *
+ * The extern "C" construct allows the main Arduino program to use the
+ * functions declared below, and to define mission_log_task().
+ */
+#ifndef _MISSION_H_
+#define _MISSION_H_
+
+#include <stdint.h>
+
+#include "scheduler.h"
+
+// Set to 1 to drive in slow circles instead of towards the target heading.
+// The log of such a run is what tools/compass_fit.py needs to calibrate the
+// compass.
+#ifndef COMPASS_CALIBRATION_SPIN
+#define COMPASS_CALIBRATION_SPIN 0
+#endif
+
+#if COMPASS_CALIBRATION_SPIN
+#define MISSION_TIMEOUT_FRAMES (40 * SCHED_FRAMES_PER_SEC) // several circles
+#else
+#define MISSION_TIMEOUT_FRAMES (8 * SCHED_FRAMES_PER_SEC) // 8 seconds
+#endif
+
+#define MISSION_NUM_TASKS 8
+
+#ifdef __cplusplus
+extern "C" {
+#endif // #ifdef __cplusplus
+  extern const sched_task_t mission_tasks[MISSION_NUM_TASKS];
+  extern uint8_t mission_complete;
+
+  uint8_t mission_init(void);
+  void mission_log_task(void);
+#ifdef __cplusplus
+}
+#endif // #ifdef __cplusplus
+
+#endif // #ifndef _MISSION_H_
@@ -0,0 +1,409 @@
+/*
+ * file: mobility.c
+ * created: 20160906
+ * author(s): mr-augustine
+ *
+ * Defines the functions used to initialize and control the steering servo and
+ * drive motor. Sketches built without the odometer drive forward open loop.
+ */
+
+#include "cruise.h"
+#include "hal.h"
+#include "mobility.h"
+#include "motion_profile.h"
+#include "pins.h"
+#include "statevars.h"
+
+#if KINTOBOR_WITH_ODOMETER
+#include "odometer.h"
+#endif
+
+typedef enum {
+  Gear_Forward,
+  Gear_Pre_Reverse,
+  Gear_Reverse,
+  Gear_Neutral
+} Drive_Gear;
+
+static uint16_t mobility_throttle_us;
+static uint16_t mobility_steer_us;
+
+static uint8_t current_hold_iterations;
+
+// Number of neutral PWM frames left before the ESC is armed
+static volatile uint8_t tnp_frames_left;
+
+// Number of PWM frames sent so far; wraps around
+static volatile uint8_t pwm_frame_count;
+
+// Set once the main program has seen that the ESC is armed
+static uint8_t esc_armed;
+
+static const profile_limits_t throttle_limits = {
+  THROTTLE_MAX_RATE_US, THROTTLE_MAX_ACCEL_US, THROTTLE_MAX_JERK_US
+};
+static const profile_limits_t steering_limits = {
+  STEERING_MAX_RATE_US, STEERING_MAX_ACCEL_US, STEERING_MAX_JERK_US
+};
+
+static profile_t throttle_profile;
+static profile_t steering_profile;
+static uint8_t throttle_frames_seen;
+static uint8_t steering_frames_seen;
+
+Drive_Gear current_gear;
+
+static void configure_pwm_timer(void);
+
+static uint16_t elapsed_ms(uint8_t * frames_seen);
+static void resync_profile_frames(void);
+
+/* Interrupt Service Routine that triggers at the end of every PWM frame.
+ * While the ESC is being armed, each frame that passes is one more neutral
+ * pulse towards the Throttle Neutral Protection (TNP) requirement. The frame
+ * count is also the time base for the throttle and steering profiles.
+ */
+ISR(PWM_FRAME_ISR_VECT) {
+  pwm_frame_count++;
+
+  if (tnp_frames_left > 0) {
+    tnp_frames_left--;
+  }
+}
+
+/* Returns the milliseconds that have passed since the previous call with the
+ * same frames_seen counter, counted in whole PWM frames. The profiles only
+ * need to advance once per frame since the compare registers are latched once
+ * per frame.
+ */
+static uint16_t elapsed_ms(uint8_t * frames_seen) {
+  uint8_t frames = pwm_frame_count - *frames_seen;
+  *frames_seen += frames;
+
+  return frames * PWM_FRAME_MS;
+}
+
+/* Restarts both profiles' frame counts from the current frame. The profiles
+ * aren't advanced while the ESC arms or while the throttle sits in neutral,
+ * which can take longer than the 256 frames it takes the counts to wrap, so
+ * the first update after either would otherwise see a stale (and clamped)
+ * time step instead of the frame that really passed.
+ */
+static void resync_profile_frames(void) {
+  uint8_t now = pwm_frame_count;
+
+  throttle_frames_seen = now;
+  steering_frames_seen = now;
+
+  return;
+}
+
+/* Configures Timer3 to generate the steering and throttle pulses.
+ * Mode 14 (Fast PWM, TOP = ICR3) restarts the frame every PWM_FRAME_US, sets
+ * OC3B and OC3C at the start of the frame, and clears each pin when the timer
+ * matches its output compare register. The compare registers are double
+ * buffered in this mode, so a new pulse width takes effect at the start of
+ * the next frame and never cuts a pulse short.
+ * See Atmel datasheet for Mega, Section 17.9.3
+ */
+static void configure_pwm_timer(void) {
+  TCCR3A = (1 << COM3B1) | (1 << COM3C1) | (1 << WGM31);
+  TCCR3B = (1 << WGM33) | (1 << WGM32);
+
+  PWM_TOP_REG = (PWM_FRAME_US * PWM_TICKS_PER_US) - 1;
+  STEERING_COMPARE_REG = TURN_NEUTRAL * PWM_TICKS_PER_US;
+  THROTTLE_COMPARE_REG = SPEED_NEUTRAL * PWM_TICKS_PER_US;
+
+  TCNT3 = 0;
+
+  // Count the frames with the overflow interrupt
+  TIFR3 = (1 << TOV3);
+  TIMSK3 = (1 << TOIE3);
+
+  // Start the timer with a prescaler of 8
+  TCCR3B |= (1 << CS31);
+
+  return;
+}
+
+/* Starts the Throttle Neutral Protection bypass. The throttle is held at
+ * neutral and the PWM frame interrupt counts down the neutral pulses, so the
+ * rest of the system can keep initializing while the ESC arms.
+ */
+static void tnp_bypass_start(uint8_t frames) {
+  mobility_throttle_us = SPEED_NEUTRAL;
+  profile_reset(&throttle_profile, SPEED_NEUTRAL);
+  THROTTLE_COMPARE_REG = SPEED_NEUTRAL * PWM_TICKS_PER_US;
+
+  tnp_frames_left = frames;
+  esc_armed = 0;
+
+  return;
+}
+
+/* Initializes the drive motor and steering servo and starts arming the ESC.
+ * The throttle ignores drive commands until mobility_is_armed() returns 1.
+ */
+uint8_t mobility_init(void) {
+  current_gear = Gear_Neutral;
+
+  THROTTLE_PORT &= ~(1 << THROTTLE_PIN);
+  STEERING_PORT &= ~(1 << STEERING_PIN);
+
+  THROTTLE_DDR |= (1 << THROTTLE_PIN);
+  STEERING_DDR |= (1 << STEERING_PIN);
+
+  configure_pwm_timer();
+
+  cruise_init();
+  profile_init(&throttle_profile, &throttle_limits, SPEED_NEUTRAL);
+  profile_init(&steering_profile, &steering_limits, TURN_NEUTRAL);
+  resync_profile_frames();
+
+  // Begin Throttle Neutral Protection bypass; this doesn't block
+  tnp_bypass_start(TNP_MIN_FRAMES);
+
+  mobility_stop();
+  mobility_steer(TURN_NEUTRAL);
+
+  return 1;
+}
+
+void mobility_drive_fwd(Drive_Speed speed) {
+  // Keep the throttle at neutral until the ESC has been armed
+  if (!mobility_is_armed()) {
+    return;
+  }
+
+  if (current_gear == Gear_Forward || current_gear == Gear_Neutral) {
+    if (current_gear == Gear_Neutral) {
+      resync_profile_frames();
+    }
+
+    uint16_t dt_ms = elapsed_ms(&throttle_frames_seen);
+
+#if KINTOBOR_WITH_ODOMETER
+    uint16_t speed_mmps = odometer_get_speed_mmps();
+#else
+    // Without an odometer the cruise controller sees no speed error and
+    // drives with the calibration table's throttle alone
+    uint16_t speed_mmps = speed;
+#endif
+
+    // Let the cruise controller pick the throttle that holds the target speed
+    uint16_t target_speed_us = cruise_update(speed, speed_mmps, dt_ms);
+
+    // Move towards that throttle along the throttle profile. The objective
+    // here is to have the robot throttle up (and down) smoothly.
+    mobility_throttle_us = profile_update(&throttle_profile, target_speed_us,
+                                          dt_ms);
+
+    // Update the gear to forward in case we entered this function while neutral
+    current_gear = Gear_Forward;
+
+    THROTTLE_COMPARE_REG = mobility_throttle_us * PWM_TICKS_PER_US;
+
+    statevars.mobility_motor_pwm = mobility_throttle_us;
+  }
+
+  // NOTE: We're not handling the case where the robot is driving in reverse.
+  // That case is outside of this function's scope.
+}
+
+void mobility_drive_rev(Drive_Speed speed) {
+  // Keep the throttle at neutral until the ESC has been armed
+  if (!mobility_is_armed()) {
+    return;
+  }
+
+  // If you've already completed the reverse init
+  // Identify the PWM that corresponds with the specified speed
+  if (current_gear == Gear_Reverse) {
+    uint16_t target_speed_us = SPEED_NEUTRAL;
+
+    switch(speed) {
+      case Speed_Creep:
+        target_speed_us = SPEED_REV_CREEP;
+        break;
+      case Speed_Cruise:
+        target_speed_us = SPEED_REV_CRUISE;
+        break;
+      case Speed_Ludicrous:
+        target_speed_us = SPEED_REV_LUDICROUS;
+        break;
+      default:
+        // target_speed_us will be neutral
+        // TODO consider reporting an error in this case
+        ;
+    }
+
+    //
+    if (mobility_throttle_us > target_speed_us) {
+      mobility_throttle_us -= REV_RATE_US;
+    }
+    // Note: if you're trying to reduce your reverse speed, you will immediately
+    // adjust the PWM signal to the target speed. We're more concerned about
+    // ramping up the reverse speed gradually.
+    else {
+      mobility_throttle_us = target_speed_us;
+    }
+    // continue decreasing PWM until you hit Drive_Speed
+  }
+
+  // If you haven't completed the reverse init
+  else {
+    switch (current_gear) {
+      case Gear_Forward:
+        // TODO Consider a different way of handling this. This code might cause
+        // stress to the drive gear because the robot wouldn't have stopped for
+        // very long before reversing directions. On the other hand, we might
+        // be relying on the Electronic Speed Control to prevent immediate
+        // reversal until the pre-reverse is performed.
+        mobility_stop();
+        return;
+        break;
+      case Gear_Neutral:
+        current_gear = Gear_Pre_Reverse;
+        mobility_throttle_us -= REV_RATE_US;
+        break;
+      case Gear_Pre_Reverse:
+        if (mobility_throttle_us > PRE_REV_STOP_US) {
+          mobility_throttle_us -= REV_RATE_US;
+          current_hold_iterations = 0;
+        } else {
+          // Setting the throtte in case the REV_RATE_US and PWM values don't
+          // create a value expressed in hundreds of microseconds
+          mobility_throttle_us = PRE_REV_STOP_US;
+
+          // continue to hold the pre_reverse_stop signal until counter expires
+          if (current_hold_iterations < PRE_REV_HOLD_ITERS) {
+            current_hold_iterations++;
+          } else {
+            current_gear = Gear_Reverse;
+            mobility_throttle_us = SPEED_NEUTRAL;
+            current_hold_iterations = 0;
+          }
+        }
+        break;
+      default:
+        // TODO consider reporting an error in this case
+        ;
+    }
+    // If you're Gear_Forward, call mobility_stop()
+    // Else If you're Gear_Neutral, start Driving_Pre_Reverse
+    // Else if you're Driving_Pre_Reverse, continue decreasing PWM until you hit stop, then wait
+  }
+
+  // The reverse sequence sets the throttle directly
+  profile_reset(&throttle_profile, mobility_throttle_us);
+
+  THROTTLE_COMPARE_REG = mobility_throttle_us * PWM_TICKS_PER_US;
+
+  statevars.mobility_motor_pwm = mobility_throttle_us;
+
+  return;
+}
+
+// Returns 1 once the ESC has seen enough neutral pulses to accept throttle
+uint8_t mobility_is_armed(void) {
+  if (!esc_armed && tnp_frames_left == 0) {
+    resync_profile_frames();
+    esc_armed = 1;
+  }
+
+  return esc_armed;
+}
+
+// Returns 1 once mobility_stop() has brought the drive motor to neutral
+uint8_t mobility_is_stopped(void) {
+  return (current_gear == Gear_Neutral);
+}
+
+// TODO This function probably wouldn't produce the desired effect. The objective
+// is to force a rapid deceleration, not an immediate coast.
+void mobility_hardstop(void) {
+  mobility_throttle_us = SPEED_NEUTRAL;
+  profile_reset(&throttle_profile, SPEED_NEUTRAL);
+  cruise_init();
+
+  THROTTLE_COMPARE_REG = SPEED_NEUTRAL * PWM_TICKS_PER_US;
+
+  statevars.mobility_motor_pwm = mobility_throttle_us;
+
+  return;
+}
+
+void mobility_stop(void) {
+  switch (current_gear) {
+
+    // If you're already in neutral
+    case Gear_Neutral:
+      mobility_throttle_us = SPEED_NEUTRAL;
+      break;
+
+    // If you're currently driving forward and want to stop, bring the PWM
+    // signal down along the throttle profile. Continue doing so for subsequent
+    // iterations until the PWM width equals 1500. Then change the current_gear
+    // to Gear_Neutral.
+    case Gear_Forward:
+      mobility_throttle_us = profile_update(&throttle_profile, SPEED_NEUTRAL,
+                                            elapsed_ms(&throttle_frames_seen));
+      if (mobility_throttle_us <= SPEED_NEUTRAL) {
+        mobility_throttle_us = SPEED_NEUTRAL;
+        current_gear = Gear_Neutral;
+
+        // Start the next drive without any trim left over from this one
+        cruise_init();
+      }
+      break;
+
+    // Likewise, if you're currently driving in reverse and want to stop, increase
+    // the PWM signal by a certain amount for this iteration. Continue doing so
+    // until the PWM width equals 1500. Then change the current_gear to
+    // Gear_Neutral.
+    case Gear_Reverse:
+      if (mobility_throttle_us < SPEED_NEUTRAL) {
+        mobility_throttle_us += REV_TO_STOP_RATE_US;
+      } else {
+        mobility_throttle_us = SPEED_NEUTRAL;
+        current_gear = Gear_Neutral;
+      }
+      profile_reset(&throttle_profile, mobility_throttle_us);
+      break;
+
+    default:
+      // TODO consider reporting an error in this case
+      ;
+  }
+
+  THROTTLE_COMPARE_REG = mobility_throttle_us * PWM_TICKS_PER_US;
+
+  statevars.mobility_motor_pwm = mobility_throttle_us;
+
+  return;
+}
+
+void mobility_steer(uint16_t steer_pwm) {
+  // Steering values greater than 1500 will steer Left. And steering values
+  // less than 1500 will steer Right. This code snippet prevents the
+  // steering servo from getting a signal that would command it beyond its
+  // turn limits.
+  if (steer_pwm < TURN_FULL_RIGHT) {
+    steer_pwm = TURN_FULL_RIGHT;
+  }
+
+  if (steer_pwm > TURN_FULL_LEFT) {
+    steer_pwm = TURN_FULL_LEFT;
+  }
+
+  // Move towards the commanded angle along the steering profile so that the
+  // servo doesn't overshoot
+  mobility_steer_us = profile_update(&steering_profile, steer_pwm,
+                                     elapsed_ms(&steering_frames_seen));
+
+  STEERING_COMPARE_REG = mobility_steer_us * PWM_TICKS_PER_US;
+
+  statevars.mobility_steering_pwm = mobility_steer_us;
+
+  return;
+}
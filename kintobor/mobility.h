@@ -0,0 +1,78 @@
+/*
+ * file: mobility.h
+ * created: 20160906
+ * author(s): mr-augustine
+ *
+ * Lists the functions used to initialize and control the steering servo and
+ * drive motor.
+ *
+ * The extern "C" construct allows the main Arduino program to use the
+ * functions declared below.
+ */
+#ifndef _MOBILITY_H_
+#define _MOBILITY_H_
+
+#include <stdint.h>
+
+/* The steering and throttle pulses are generated by Timer3 in Fast PWM mode
+ * with ICR3 as TOP. The steering pin (PE4) is OC3B and the throttle pin (PE5)
+ * is OC3C, so the hardware raises and clears both pins on its own. With a
+ * prescaler of 8, each Timer3 tick is 0.5 microseconds.
+ */
+#define PWM_TOP_REG           ICR3
+#define STEERING_COMPARE_REG  OCR3B
+#define THROTTLE_COMPARE_REG  OCR3C
+#define PWM_TICKS_PER_US      2
+#define PWM_FRAME_US          20000UL // one pulse every 20 ms (50 Hz)
+#define PWM_FRAME_MS          (PWM_FRAME_US / 1000)
+#define PWM_FRAME_ISR_VECT    TIMER3_OVF_vect
+
+// Throttle and steering motion profile limits; see motion_profile.h
+#define THROTTLE_MAX_RATE_US  8000    // microseconds per second
+#define THROTTLE_MAX_ACCEL_US 40000   // microseconds per second^2
+#define THROTTLE_MAX_JERK_US  800000  // microseconds per second^3
+#define STEERING_MAX_RATE_US  4000    // full left to full right in 0.2 s
+#define STEERING_MAX_ACCEL_US 40000
+#define STEERING_MAX_JERK_US  0       // trapezoidal profile
+
+#define REV_TO_STOP_RATE_US   100
+#define REV_RATE_US           10
+#define PRE_REV_STOP_US       1400
+#define PRE_REV_HOLD_ITERS    40
+#define TNP_MIN_FRAMES        125   // minimum number of neutral PWM frames
+                                    // (2.5 s) for throttle neutral protection
+
+#define SPEED_NEUTRAL         1500
+#define SPEED_REV_CREEP       1400
+#define SPEED_REV_CRUISE      1200
+#define SPEED_REV_LUDICROUS   1100
+#define TURN_FULL_LEFT        1900
+#define TURN_FULL_RIGHT       1100
+#define TURN_NEUTRAL          1500
+
+/* Forward speeds are targets for the cruise controller (see cruise.h) and
+ * are given in millimeters per second. Reverse is still open loop, so the
+ * reverse throttle for each speed is one of the SPEED_REV_* values above.
+ */
+typedef enum {
+  Speed_Creep = 500,
+  Speed_Cruise = 1500,
+  Speed_Ludicrous = 3000
+} Drive_Speed;
+
+#ifdef __cplusplus
+extern "C" {
+#endif // #ifdef __cplusplus
+  uint8_t mobility_init(void);
+  void mobility_drive_fwd(Drive_Speed speed);
+  void mobility_drive_rev(Drive_Speed speed);
+  void mobility_hardstop(void);
+  uint8_t mobility_is_armed(void);
+  uint8_t mobility_is_stopped(void);
+  void mobility_stop(void);
+  void mobility_steer(uint16_t steer_pwm);
+#ifdef __cplusplus
+}
+#endif // #ifdef __cplusplus
+
+#endif // #ifndef _MOBILITY_H_
@@ -0,0 +1,138 @@
+/*
+ * file: motion_profile.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Defines the jerk- and acceleration-limited setpoint generator used for the
+ * drive motor and steering servo.
+ *
+ * On every update we work out the fastest rate that would still let us stop
+ * at the target with the acceleration limit (v = sqrt(2 * a * distance)),
+ * accelerate towards that rate, and then advance the setpoint. If a step
+ * would carry the setpoint past the target, the setpoint is placed on the
+ * target and the motion stops there.
+ */
+#include "motion_profile.h"
+
+#define MS_PER_SEC 1000
+#define PROFILE_MAX_DISTANCE_US 16383
+
+static uint16_t isqrt32(uint32_t n);
+static int32_t clamp(int32_t value, int32_t limit);
+
+// Integer square root using the bit-by-bit method; 16 iterations at most
+static uint16_t isqrt32(uint32_t n) {
+  uint32_t root = 0;
+  uint32_t bit = 1UL << 30;
+
+  while (bit > n) {
+    bit >>= 2;
+  }
+
+  while (bit != 0) {
+    if (n >= root + bit) {
+      n -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+
+  return root;
+}
+
+// Limits value to the range [-limit, limit]
+static int32_t clamp(int32_t value, int32_t limit) {
+  if (value > limit) {
+    return limit;
+  }
+
+  if (value < -limit) {
+    return -limit;
+  }
+
+  return value;
+}
+
+void profile_init(profile_t * p, const profile_limits_t * limits, uint16_t start_us) {
+  p->limits = limits;
+  profile_reset(p, start_us);
+
+  return;
+}
+
+/* Places the setpoint directly at the specified value and stops all motion.
+ * Use this when the output was set without going through the profile.
+ */
+void profile_reset(profile_t * p, uint16_t setpoint_us) {
+  p->setpoint = (int32_t) setpoint_us << PROFILE_FRAC_BITS;
+  p->rate = 0;
+  p->accel = 0;
+
+  return;
+}
+
+/* Advances the profile by dt_ms towards target_us and returns the new
+ * setpoint in microseconds.
+ */
+uint16_t profile_update(profile_t * p, uint16_t target_us, uint16_t dt_ms) {
+  const profile_limits_t * limits = p->limits;
+  int32_t target = (int32_t) target_us << PROFILE_FRAC_BITS;
+  int32_t error = target - p->setpoint;
+
+  if (dt_ms == 0) {
+    return p->setpoint >> PROFILE_FRAC_BITS;
+  }
+
+  if (dt_ms > PROFILE_MAX_DT_MS) {
+    dt_ms = PROFILE_MAX_DT_MS;
+  }
+
+  if (error == 0 && p->rate == 0) {
+    p->accel = 0;
+    return target_us;
+  }
+
+  // Fastest rate from which we can still stop at the target
+  uint32_t distance_us = (error < 0 ? -error : error) >> PROFILE_FRAC_BITS;
+
+  // Keep 2 * a * d within 32 bits; no output travels this far anyway
+  if (distance_us > PROFILE_MAX_DISTANCE_US) {
+    distance_us = PROFILE_MAX_DISTANCE_US;
+  }
+
+  int32_t rate_desired = isqrt32(2UL * limits->max_accel * distance_us);
+
+  if (rate_desired > limits->max_rate) {
+    rate_desired = limits->max_rate;
+  }
+
+  if (error < 0) {
+    rate_desired = -rate_desired;
+  }
+
+  // Acceleration needed to reach that rate during this update
+  int32_t accel = (rate_desired - p->rate) * MS_PER_SEC / dt_ms;
+  accel = clamp(accel, limits->max_accel);
+
+  if (limits->max_jerk != 0) {
+    int32_t accel_step = limits->max_jerk * dt_ms / MS_PER_SEC;
+    accel = p->accel + clamp(accel - p->accel, accel_step);
+  }
+
+  p->accel = accel;
+  p->rate = clamp(p->rate + accel * dt_ms / MS_PER_SEC, limits->max_rate);
+
+  int32_t step = (p->rate * dt_ms * (1L << PROFILE_FRAC_BITS)) / MS_PER_SEC;
+
+  // Stop on the target rather than overshooting it
+  if ((error > 0 && step >= error) || (error < 0 && step <= error)) {
+    profile_reset(p, target_us);
+    return target_us;
+  }
+
+  p->setpoint += step;
+
+  return p->setpoint >> PROFILE_FRAC_BITS;
+}
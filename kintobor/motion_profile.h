@@ -0,0 +1,48 @@
+/*
+ * file: motion_profile.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Lists the types and functions used to generate smooth PWM setpoints for
+ * the drive motor and steering servo. A profile moves its setpoint towards a
+ * target no faster than the rate limit, changes the rate no faster than the
+ * acceleration limit, and (optionally) changes the acceleration no faster
+ * than the jerk limit. A jerk limit of zero gives a trapezoidal profile.
+ *
+ * All of the math is done with integers. The setpoint is kept in 1/256ths of
+ * a microsecond so that small per-update steps aren't lost to rounding.
+ * Every update is told how much time has elapsed, so the profile behaves the
+ * same no matter how often it is updated.
+ */
+#ifndef _MOTION_PROFILE_H_
+#define _MOTION_PROFILE_H_
+
+#include <stdint.h>
+
+#define PROFILE_FRAC_BITS     8
+#define PROFILE_MAX_DT_MS     100   // longer gaps are treated as 100 ms
+
+typedef struct {
+  uint16_t max_rate;    // microseconds per second
+  uint16_t max_accel;   // microseconds per second^2
+  uint32_t max_jerk;    // microseconds per second^3; zero means no limit
+} profile_limits_t;
+
+typedef struct {
+  const profile_limits_t * limits;
+  int32_t setpoint;     // microseconds << PROFILE_FRAC_BITS
+  int32_t rate;         // microseconds per second
+  int32_t accel;        // microseconds per second^2
+} profile_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif // #ifdef __cplusplus
+  void profile_init(profile_t * p, const profile_limits_t * limits, uint16_t start_us);
+  void profile_reset(profile_t * p, uint16_t setpoint_us);
+  uint16_t profile_update(profile_t * p, uint16_t target_us, uint16_t dt_ms);
+#ifdef __cplusplus
+}
+#endif // #ifdef __cplusplus
+
+#endif // #ifndef _MOTION_PROFILE_H_
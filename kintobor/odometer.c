@@ -0,0 +1,274 @@
+/*
+ * file: odometer.c
+ * created: 20160906
+ * author(s): mr-augustine
+ *
+ * Defines the functions used to operate the odometer. This library counts
+ * the number rotations performed by the robot's drive gear; and stores the
+ * value in a statevars variable.
+ *
+ * The rotations are detected by a hall effect sensor which observes a magnet
+ * affixed to the drive gear. The sensor is wired to Timer5's input capture
+ * pin, so every tick is timestamped in hardware against the free-running
+ * timebase (see timebase.h) and the speed comes from the period between ticks.
+ */
+
+#include "hal.h"
+#include "odometer.h"
+#include "sample.h"
+#include "snapshot.h"
+#include "statevars.h"
+#include "timebase.h"
+#include "uwrite.h"
+
+// The ISR updates the counts and the ring inside a write section of odometer_seq
+static snapshot_seq_t odometer_seq;
+static volatile uint32_t fwd_count;
+static volatile uint32_t rev_count;
+static Wheel_Direction wheel_turn_direction;
+
+/* The timestamps of the most recent ticks. The ISR is the only writer: it
+ * fills the slot at tick_head and then advances tick_head, so the main program
+ * can read the slots behind a snapshot of tick_head without any locking; those
+ * slots won't be written again until the ring wraps around.
+ */
+static volatile uint32_t tick_ring[ODOMETER_RING_SIZE];   // timebase ticks
+static volatile uint8_t tick_head;    // next slot to fill; wraps around
+static volatile uint8_t tick_count;   // filled slots; stops at the ring size
+
+static uint16_t speed_mmps;
+static uint8_t speed_periods;
+static uint32_t speed_span;
+static uint8_t stamped_head;        // tick_head when odometer_meta was stamped
+
+static void initialize_odometer_statevars(void);
+static void update_speed(uint8_t head, uint8_t count, uint32_t now);
+
+/* Interrupt Service Routine that triggers when Timer5 captures an odometer
+ * tick. The capture happens in hardware on the sensor's falling edge, so the
+ * timestamp doesn't depend on how long it took for this ISR to run.
+ */
+ISR(ODOMETER_ISR_VECT) {
+  uint32_t capture_time = timebase_extend(TIMEBASE_CAPTURE_REG);
+
+  snapshot_write_begin(&odometer_seq);
+
+  // Increment the approriate count variable (fwd_count or rev_count)
+  if (wheel_turn_direction == Direction_Forward) {
+    fwd_count++;
+  } else {
+    rev_count++;
+  }
+
+  tick_ring[tick_head & ODOMETER_RING_MASK] = capture_time;
+  tick_head++;
+
+  if (tick_count < ODOMETER_RING_SIZE) {
+    tick_count++;
+  }
+
+  snapshot_write_end(&odometer_seq);
+}
+
+/* Measures the speed from the most recent tick periods. Up to
+ * ODOMETER_SPEED_PERIODS periods are averaged, but older periods are left out
+ * once they would stretch the measurement past ODOMETER_SPEED_SPAN_TICKS; at
+ * speed that gives a smooth average and at a creep it still follows changes.
+ *
+ * The next tick can't arrive any sooner than the time that has already passed
+ * since the last one. When that is longer than the average period, the wheel
+ * has slowed down and the speed is taken from the time since the last tick
+ * instead, so it decays to zero when the wheel stops turning.
+ */
+static void update_speed(uint8_t head, uint8_t count, uint32_t now) {
+  uint8_t periods = 0;
+  uint32_t span = 0;
+
+  if (count > 0) {
+    uint32_t latest = tick_ring[(uint8_t) (head - 1) & ODOMETER_RING_MASK];
+
+    while (periods < ODOMETER_SPEED_PERIODS && periods + 1 < count) {
+      uint8_t slot = (uint8_t) (head - periods - 2) & ODOMETER_RING_MASK;
+      uint32_t longer_span = latest - tick_ring[slot];
+
+      if (periods > 0 && longer_span > ODOMETER_SPEED_SPAN_TICKS) {
+        break;
+      }
+
+      span = longer_span;
+      periods++;
+    }
+
+    uint32_t since_tick = now - latest;
+
+    if (periods > 0 && (since_tick > span || since_tick * periods > span)) {
+      span = since_tick;
+      periods = 1;
+    }
+  }
+
+  speed_periods = periods;
+  speed_span = span;
+
+  if (periods == 0 || span > ODOMETER_STOPPED_TICKS * periods) {
+    speed_mmps = 0;
+    return;
+  }
+
+  // Micrometers per millisecond is the same as millimeters per second
+  uint32_t speed = periods * ODOMETER_UM_PER_TICK * TIMEBASE_TICKS_PER_MS / span;
+  speed_mmps = (speed > UINT16_MAX) ? UINT16_MAX : speed;
+
+  return;
+}
+
+static void initialize_odometer_statevars(void) {
+  statevars.odometer_ticks = 0.0;
+  sample_reset(&statevars.odometer_meta);
+  statevars.odometer_ticks_are_fwd = 1;
+  statevars.odometer_speed_span = 0;
+  statevars.odometer_speed_periods = 0;
+  statevars.odometer_speed_mmps = 0;
+
+  return;
+}
+
+uint8_t odometer_init(void) {
+  // Turn on the pull-up resistor for the odometer pin
+  ODOMETER_PORT |= (1 << ODOMETER_PIN);
+
+  // Set the odometer pin as an input
+  ODOMETER_DDR &= ~(1 << ODOMETER_PIN);
+
+  // Capture Timer5 on the falling edge of the odometer pin. The pin is
+  // normally high when the magnet is not present, and then becomes low when
+  // the magnet passes in front of it. The noise canceler requires the pin to
+  // be low for four samples before the capture is triggered.
+  // See Section 17.6 in the Atmel specs
+  TCCR5B &= ~(1 << ICES5);
+  TCCR5B |= (1 << ICNC5);
+
+  // Clear any capture that happened before we were ready and enable interrupts
+  TIFR5 = (1 << ICF5);
+  TIMSK5 |= (1 << ICIE5);
+
+  odometer_reset();
+  odometer_set_direction(Direction_Forward);
+  initialize_odometer_statevars();
+
+  return 1;
+}
+
+void odometer_reset(void) {
+  uint8_t sreg = SREG;
+  cli();
+
+  fwd_count = 0;
+  rev_count = 0;
+  tick_head = 0;
+  tick_count = 0;
+
+  SREG = sreg;
+
+  stamped_head = 0;
+
+  speed_mmps = 0;
+  speed_periods = 0;
+  speed_span = 0;
+
+  return;
+}
+
+void odometer_set_direction(Wheel_Direction wd) {
+  wheel_turn_direction = wd;
+
+  return;
+}
+
+uint32_t odometer_get_fwd_count(void) {
+  uint32_t count;
+  uint8_t seq;
+
+  do {
+    seq = snapshot_read_begin(&odometer_seq);
+    count = fwd_count;
+  } while (snapshot_read_retry(&odometer_seq, seq));
+
+  return count;
+}
+
+uint32_t odometer_get_rev_count(void) {
+  uint32_t count;
+  uint8_t seq;
+
+  do {
+    seq = snapshot_read_begin(&odometer_seq);
+    count = rev_count;
+  } while (snapshot_read_retry(&odometer_seq, seq));
+
+  return count;
+}
+
+// Returns the timebase timestamp of the most recent tick; zero if none yet
+uint32_t odometer_get_tick_time(void) {
+  uint8_t head;
+  uint8_t count;
+  uint8_t seq;
+
+  do {
+    seq = snapshot_read_begin(&odometer_seq);
+    head = tick_head;
+    count = tick_count;
+  } while (snapshot_read_retry(&odometer_seq, seq));
+
+  if (count == 0) {
+    return 0;
+  }
+
+  return tick_ring[(uint8_t) (head - 1) & ODOMETER_RING_MASK];
+}
+
+// Returns the most recently measured speed in millimeters per second
+uint16_t odometer_get_speed_mmps(void) {
+  return speed_mmps;
+}
+
+void odometer_update(void) {
+  uint32_t fwd_ticks;
+  uint32_t rev_ticks;
+  uint8_t head;
+  uint8_t count;
+  uint8_t seq;
+
+  // The counts are shared with the ISR and are too wide to read atomically
+  do {
+    seq = snapshot_read_begin(&odometer_seq);
+    fwd_ticks = fwd_count;
+    rev_ticks = rev_count;
+    head = tick_head;
+    count = tick_count;
+  } while (snapshot_read_retry(&odometer_seq, seq));
+
+  if (wheel_turn_direction == Direction_Forward) {
+    statevars.odometer_ticks = fwd_ticks;
+    statevars.odometer_ticks_are_fwd = 1;
+  } else {
+    statevars.odometer_ticks = rev_ticks;
+    statevars.odometer_ticks_are_fwd = 0;
+  }
+
+  update_speed(head, count, timebase_now());
+
+  // The tick counts were last measured when the most recent tick arrived
+  if (count > 0 && head != stamped_head) {
+    sample_stamp(&statevars.odometer_meta,
+                 tick_ring[(uint8_t) (head - 1) & ODOMETER_RING_MASK], 1);
+    stamped_head = head;
+  }
+
+  statevars.odometer_speed_mmps = speed_mmps;
+  statevars.odometer_speed_span = speed_span;
+  statevars.odometer_speed_periods = speed_periods;
+
+  return;
+}
@@ -0,0 +1,54 @@
+/*
+ * file: odometer.h
+ * created: 20160906
+ * author(s): mr-augustine
+ *
+ * Lists the functions used to initialize and update the odometer.
+ *
+ * The extern "C" construct allows the main Arduino program to use the
+ * functions declared below.
+ */
+#ifndef _ODOMETER_H_
+#define _ODOMETER_H_
+
+#include "hal.h"
+#include "pins.h"
+#include "timebase.h"
+
+// Ticks are captured in hardware by Timer5; see timebase.h
+#define ODOMETER_ISR_VECT             TIMEBASE_CAPTURE_ISR_VECT
+
+// The wheel travels 1/7.6 meters between ticks
+#define ODOMETER_UM_PER_TICK          131579UL
+// No tick for this long (in timebase ticks) means the wheel has stopped
+#define ODOMETER_STOPPED_TICKS        (1000UL * TIMEBASE_TICKS_PER_MS)
+
+// Tick timestamps kept by the ISR; must be a power of two
+#define ODOMETER_RING_SIZE            16
+#define ODOMETER_RING_MASK            (ODOMETER_RING_SIZE - 1)
+// The speed is averaged over at most this many periods...
+#define ODOMETER_SPEED_PERIODS        8
+// ...as long as they span no more than this many timebase ticks
+#define ODOMETER_SPEED_SPAN_TICKS     (200UL * TIMEBASE_TICKS_PER_MS)
+
+typedef enum {
+  Direction_Forward,
+  Direction_Reverse
+} Wheel_Direction;
+
+#ifdef __cplusplus
+extern "C" {
+#endif // #ifdef __cplusplus
+  uint8_t odometer_init(void);
+  void odometer_reset(void);
+  void odometer_set_direction(Wheel_Direction wd);
+  uint32_t odometer_get_fwd_count(void);
+  uint32_t odometer_get_rev_count(void);
+  uint32_t odometer_get_tick_time(void);
+  uint16_t odometer_get_speed_mmps(void);
+  void odometer_update(void);
+#ifdef __cplusplus
+}
+#endif // #ifdef __cplusplus
+
+#endif // #ifndef _ODOMETER_H_
@@ -0,0 +1,47 @@
+/*
+ * file: publish.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Defines the published statevars record and its hand-off to the consumer.
+ * Only the main program publishes and releases (i.e., tasks and background
+ * jobs, never an ISR), so the hand-off needs no locking.
+ */
+#include <stdint.h>
+#include <string.h>
+
+#include "publish.h"
+#include "statevars.h"
+
+static statevars_t published_record;
+
+// Set from the publish until the consumer releases the record
+static uint8_t published_held;
+
+/* Copies the live statevars into the published record and hands it to the
+ * consumer, unless the consumer still holds the previous one.
+ * Returns 1 if the record was published; 0 if it was skipped
+ */
+uint8_t statevars_publish(void) {
+  if (published_held) {
+    statevars.publish_skipped++;
+    return 0;
+  }
+
+  memcpy(&published_record, &statevars, sizeof(statevars));
+  published_held = 1;
+
+  return 1;
+}
+
+// Returns the most recently published record
+const statevars_t * statevars_published(void) {
+  return &published_record;
+}
+
+// Lets the next statevars_publish() overwrite the published record
+void statevars_release(void) {
+  published_held = 0;
+
+  return;
+}
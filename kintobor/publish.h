@@ -0,0 +1,47 @@
+/*
+ * file: publish.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Lists the functions used to hand complete statevars records to a consumer
+ * such as the SD card logger.
+ *
+ * The tasks keep updating the live statevars while the robot runs, so a
+ * consumer that read it directly over several frames could get a record that
+ * is half from one loop and half from the next. Instead, the sketch publishes
+ * the record once it is complete: statevars_publish() copies the live
+ * statevars into the published record and hands it to the consumer, which
+ * reads it in place from statevars_published() for as long as it needs to and
+ * then gives it back with statevars_release().
+ *
+ * There is only the one published record. While the consumer holds it,
+ * statevars_publish() leaves it alone, counts the record it couldn't publish
+ * in statevars.publish_skipped, and returns 0, so a consumer that falls behind
+ * loses whole records rather than getting torn ones.
+ *
+ * The record is copied rather than swapped with the live one because nearly
+ * every field carries over from one loop to the next (e.g., the sensor values
+ * and the scheduler's statistics), so a swapped-in buffer would need the same
+ * copy to start from.
+ *
+ * The extern "C" construct allows the main Arduino program to use the
+ * functions declared below.
+ */
+#ifndef _PUBLISH_H_
+#define _PUBLISH_H_
+
+#include <stdint.h>
+
+#include "statevars.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif // #ifdef __cplusplus
+  uint8_t statevars_publish(void);
+  const statevars_t * statevars_published(void);
+  void statevars_release(void);
+#ifdef __cplusplus
+}
+#endif // #ifdef __cplusplus
+
+#endif // #ifndef _PUBLISH_H_
@@ -0,0 +1,114 @@
+/*
+ * file: ram.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Defines the RAM painting and the high-water mark scan. The memory map comes
+ * from the linker and avr-libc:
+ *   _end       the end of .bss, where the heap starts
+ *   __brkval   the top of the heap; 0 until malloc() is first used
+ *   __stack    the top of the SRAM (RAMEND), where the stack starts
+ *
+ * The host build (tools/host) has no such memory map and leaves this file out.
+ */
+#include <stdint.h>
+
+#include "ram.h"
+#include "scheduler.h"
+#include "statevars.h"
+#include "timebase.h"
+
+extern uint8_t _end;
+extern uint8_t __stack;
+extern char * __brkval;
+
+static uint8_t * scan_ptr;
+static uint8_t * scan_heap_top;
+static uint8_t * stack_low = &__stack + 1;  // the deepest stack byte seen
+static uint16_t free_min = UINT16_MAX;
+static uint8_t scan_running;
+static uint32_t last_scan_at;
+
+void ram_paint(void) __attribute__ ((naked, used, section (".init1")));
+static uint8_t ram_scan_job(void);
+
+/* Paints the RAM from the end of .bss to the top of the SRAM. This runs in
+ * .init1, before the stack pointer and the zero register have been set up, so
+ * it can't call anything or rely on r1; it falls through to .init2 instead of
+ * returning.
+ */
+void ram_paint(void) {
+  __asm__ __volatile__ (
+      "    ldi r30, lo8(_end)     \n"
+      "    ldi r31, hi8(_end)     \n"
+      "    ldi r24, %0            \n"
+      "    ldi r25, hi8(__stack)  \n"
+      "    rjmp 2f                \n"
+      "1:  st Z+, r24             \n"
+      "2:  cpi r30, lo8(__stack)  \n"
+      "    cpc r31, r25           \n"
+      "    brlo 1b                \n"
+      "    breq 1b                \n"
+      :: "M" (RAM_PAINT));
+}
+
+/* Starts a scan once every RAM_SCAN_PERIOD_MS. Call it from a periodic task;
+ * the scan itself runs as a background job.
+ */
+void ram_update(void) {
+  uint32_t now = timebase_now();
+
+  if (scan_running ||
+      now - last_scan_at < RAM_SCAN_PERIOD_MS * TIMEBASE_TICKS_PER_MS) {
+    return;
+  }
+
+  scan_heap_top = (__brkval != 0) ? (uint8_t *) __brkval : &_end;
+  scan_ptr = scan_heap_top;
+
+  if (sched_post_job(ram_scan_job, RAM_SCAN_STEP_TICKS)) {
+    scan_running = 1;
+    last_scan_at = now;
+  }
+
+  return;
+}
+
+/* Background job that looks at up to RAM_SCAN_STEP_BYTES more bytes for the
+ * first one that isn't paint. Nothing above the deepest stack byte seen by an
+ * earlier scan needs looking at again. Returns SCHED_JOB_MORE while there is
+ * more to scan.
+ */
+static uint8_t ram_scan_job(void) {
+  uint8_t * end = scan_ptr + RAM_SCAN_STEP_BYTES;
+  if (end > stack_low) {
+    end = stack_low;
+  }
+
+  while (scan_ptr < end && *scan_ptr == RAM_PAINT) {
+    scan_ptr++;
+  }
+
+  if (scan_ptr == end && end != stack_low) {
+    return SCHED_JOB_MORE;
+  }
+
+  if (scan_ptr < stack_low) {
+    stack_low = scan_ptr;
+  }
+
+  // The heap may have grown past the deepest stack byte seen
+  uint16_t free_now = 0;
+  if (stack_low > scan_heap_top) {
+    free_now = stack_low - scan_heap_top;
+  }
+  if (free_now < free_min) {
+    free_min = free_now;
+  }
+
+  statevars.ram_stack_peak = &__stack + 1 - stack_low;
+  statevars.ram_free_min = free_min;
+  scan_running = 0;
+
+  return SCHED_JOB_DONE;
+}
@@ -0,0 +1,48 @@
+/*
+ * file: ram.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Lists the functions used to measure how much of the ATmega2560's 8 KB of
+ * SRAM the program really uses. The static data (.data and .bss) comes first,
+ * then the heap, which grows up, and then the free RAM that the stack grows
+ * down into from the top of the SRAM.
+ *
+ * Before the C runtime starts, everything between the end of .bss and the top
+ * of the SRAM is painted with RAM_PAINT. ram_update() scans the painted RAM
+ * from the top of the heap upwards once every RAM_SCAN_PERIOD_MS; the first
+ * byte that isn't paint any more is the deepest the stack has reached so far.
+ * The scan runs as a background job (see scheduler.h) in steps of
+ * RAM_SCAN_STEP_BYTES, so it only ever uses slack at the end of a frame.
+ *
+ * Each scan stores to statevars:
+ *   ram_stack_peak   the most stack that has been in use at once, in bytes
+ *   ram_free_min     the fewest bytes that have been left between the heap
+ *                    and the stack; when it reaches 0 they have collided
+ * Both figures err on the safe side: a byte the heap has given back also
+ * counts as stack.
+ *
+ * The extern "C" construct allows the main Arduino program to use the
+ * functions declared below.
+ */
+#ifndef _RAM_H_
+#define _RAM_H_
+
+#include <stdint.h>
+
+#include "scheduler.h"
+
+#define RAM_PAINT             0xC5
+#define RAM_SCAN_PERIOD_MS    1000
+#define RAM_SCAN_STEP_BYTES   256
+#define RAM_SCAN_STEP_TICKS   (SCHED_TICKS_PER_MS / 4)  // a step takes ~130 us
+
+#ifdef __cplusplus
+extern "C" {
+#endif // #ifdef __cplusplus
+  void ram_update(void);
+#ifdef __cplusplus
+}
+#endif // #ifdef __cplusplus
+
+#endif // #ifndef _RAM_H_
@@ -0,0 +1,55 @@
+/*
+ * file: sample.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Defines the metadata that goes along with every sensor value in statevars.
+ * Each sensor keeps one sample_meta_t next to its values:
+ *   timestamp   when the values were measured, in timebase ticks (see
+ *               timebase.h); as close to the physical measurement as the
+ *               sensor allows, not when the values were copied to statevars
+ *   seq         incremented every time new values are stored; a consumer
+ *               that sees the same seq twice has already used the values
+ *   valid       1 if the values hold a real measurement
+ *
+ * A consumer can use sample_age() to tell how old the values are and decide
+ * whether to use, extrapolate, or ignore them.
+ */
+#ifndef _SAMPLE_H_
+#define _SAMPLE_H_
+
+#include <stdint.h>
+
+typedef struct {
+  uint32_t  timestamp;
+  uint16_t  seq;
+  uint8_t   valid;
+  uint8_t   reserved;   // keeps the struct 8 bytes long on every target
+} sample_meta_t;
+
+// Records that new values measured at timestamp were just stored
+static inline void sample_stamp(sample_meta_t * meta, uint32_t timestamp,
+                                uint8_t valid) {
+  meta->timestamp = timestamp;
+  meta->seq++;
+  meta->valid = valid;
+}
+
+static inline void sample_reset(sample_meta_t * meta) {
+  meta->timestamp = 0;
+  meta->seq = 0;
+  meta->valid = 0;
+}
+
+// Returns how many timebase ticks old the values are at time now
+static inline uint32_t sample_age(const sample_meta_t * meta, uint32_t now) {
+  return now - meta->timestamp;
+}
+
+// Returns 1 if the values are valid and no older than max_age ticks
+static inline uint8_t sample_is_fresh(const sample_meta_t * meta, uint32_t now,
+                                      uint32_t max_age) {
+  return meta->valid && sample_age(meta, now) <= max_age;
+}
+
+#endif // #ifndef _SAMPLE_H_
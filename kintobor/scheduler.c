@@ -0,0 +1,290 @@
+/*
+ * file: scheduler.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Defines the table-driven cooperative scheduler. Timer1 is restarted at the
+ * beginning of every minor frame; each task that is due in the frame is run
+ * to completion in table order and then checked against its deadline. A task
+ * that finishes after its deadline has its overrun counter in statevars
+ * incremented. The remainder of the frame is spent busy-waiting.
+ *
+ * Every task is also timed with Timer1. The most recent duration, the running
+ * max and mean, and the number of runs are stored per task in statevars so the
+ * log shows which task made a frame late.
+ *
+ * The time left in a frame after the tasks have run (the slack) is handed to
+ * the background jobs. A job step only starts if its declared worst-case
+ * duration still fits in the frame; otherwise the jobs yield until the next
+ * frame. The slack before and the idle time after the background jobs are
+ * both recorded in statevars, as is how long the job steps really took.
+ */
+#include <stddef.h>
+
+#include "hal.h"
+#include "scheduler.h"
+#include "statevars.h"
+
+static const sched_task_t * task_table;
+static uint8_t task_count;
+
+// Number of frames left before each task is released again
+static uint8_t frames_until_release[SCHED_MAX_TASKS];
+
+static uint32_t frame_count;
+
+// Background jobs are kept in a ring and served round-robin
+static sched_job_t jobs[SCHED_MAX_JOBS];
+static uint8_t job_head;
+static uint8_t job_count;
+
+static volatile uint8_t system_timer_overflow = 0; // indicates frame overflow
+
+static void record_task_ticks(uint8_t task, uint16_t ticks);
+static void record_job_ticks(const sched_job_t * job, uint16_t ticks,
+                             uint16_t end_ticks);
+static void run_background_jobs(void);
+
+/* Interrupt Service Routine that triggers when a frame is running so long
+ * that Timer1 wrapped around.
+ */
+ISR(TIMER1_OVF_vect) {
+  system_timer_overflow = 1;
+}
+
+/* Stores how long a task ran and folds the sample into the task's running
+ * max and mean. The mean is an exponentially weighted average that is kept
+ * in whole timer ticks so that we don't pay for floating-point math here.
+ */
+static void record_task_ticks(uint8_t task, uint16_t ticks) {
+  statevars.sched_task_ticks[task] = ticks;
+
+  if (ticks > statevars.sched_task_max_ticks[task]) {
+    statevars.sched_task_max_ticks[task] = ticks;
+  }
+
+  if (statevars.sched_task_runs[task] == 0) {
+    statevars.sched_task_mean_ticks[task] = ticks;
+  } else {
+    int32_t mean = statevars.sched_task_mean_ticks[task];
+    mean += ((int32_t) ticks - mean) / SCHED_MEAN_WEIGHT;
+    statevars.sched_task_mean_ticks[task] = mean;
+  }
+
+  statevars.sched_task_runs[task]++;
+
+  return;
+}
+
+/* Keeps track of the longest job step, of how far a step overran the
+ * duration its job declared, and of the steps that didn't finish in the frame.
+ */
+static void record_job_ticks(const sched_job_t * job, uint16_t ticks,
+                             uint16_t end_ticks) {
+  if (ticks > statevars.sched_job_max_ticks) {
+    statevars.sched_job_max_ticks = ticks;
+  }
+
+  if (ticks > job->step_ticks &&
+      ticks - job->step_ticks > statevars.sched_job_max_over_ticks) {
+    statevars.sched_job_max_over_ticks = ticks - job->step_ticks;
+  }
+
+  if (end_ticks > SCHED_FRAME_TICKS || system_timer_overflow) {
+    statevars.sched_job_overruns++;
+  }
+
+  return;
+}
+
+/* Runs background job steps until the queue is empty, every job left is
+ * waiting for a later frame, or the next step would not finish before the end
+ * of the frame. A job that has more work is moved to the back of the queue so
+ * that every job makes progress.
+ */
+static void run_background_jobs(void) {
+  uint8_t waiting = 0;  // jobs in a row that had nothing to do
+
+  while (job_count > waiting) {
+    sched_job_t job = jobs[job_head];
+
+    if ((uint32_t) TCNT1 + job.step_ticks >= SCHED_FRAME_TICKS) {
+      break;
+    }
+
+    uint16_t start_ticks = TCNT1;
+    uint8_t result = job.step();
+    uint16_t end_ticks = TCNT1;
+
+    record_job_ticks(&job, end_ticks - start_ticks, end_ticks);
+
+    job_head = (job_head + 1) % SCHED_MAX_JOBS;
+    job_count--;
+
+    if (result == SCHED_JOB_DONE) {
+      statevars.sched_jobs_done++;
+    } else {
+      jobs[(job_head + job_count) % SCHED_MAX_JOBS] = job;
+      job_count++;
+
+      waiting = (result == SCHED_JOB_WAIT) ? waiting + 1 : 0;
+    }
+  }
+
+  return;
+}
+
+/* Validates the task table and prepares each task's release counter.
+ * Returns 1 if the table can be scheduled; 0 otherwise
+ */
+uint8_t sched_init(const sched_task_t * tasks, uint8_t num_tasks) {
+  if (tasks == NULL || num_tasks == 0 || num_tasks > SCHED_MAX_TASKS) {
+    return 0;
+  }
+
+  uint8_t i;
+  for (i = 0; i < num_tasks; i++) {
+    if (tasks[i].run == NULL || tasks[i].period_frames == 0) {
+      return 0;
+    }
+
+    if (tasks[i].offset_frames >= tasks[i].period_frames) {
+      return 0;
+    }
+
+    if (tasks[i].deadline_ticks > SCHED_FRAME_TICKS) {
+      return 0;
+    }
+
+    frames_until_release[i] = tasks[i].offset_frames;
+  }
+
+  task_table = tasks;
+  task_count = num_tasks;
+  frame_count = 0;
+
+  job_head = 0;
+  job_count = 0;
+
+  statevars.sched_min_slack_ticks = SCHED_FRAME_TICKS;
+
+  return 1;
+}
+
+/* Configures Timer1 as the frame clock and enables its overflow interrupt.
+ * For a prescale value of 64, the timer counts 250,000 ticks/sec, which gives
+ * us 4 microseconds/tick. See Atmel datasheet for Mega, Section 17.11
+ */
+void sched_start(void) {
+  cli();
+
+  TCCR1A = 0b00000000; // Normal operation; no waveform generation by default
+  TCCR1B = 0b00000011; // No input capture, waveform gen; prescaler = 64
+  TCCR1C = 0b00000000; // No output compare
+  TIMSK1 = 0b00000001; // Enable the overflow interrupt
+
+  TCNT1 = 0;
+  system_timer_overflow = 0;
+
+  sei();
+
+  return;
+}
+
+/* Runs every task that is due in the current frame and then waits for the
+ * frame to end. If the frame ran long, we return immediately so that the next
+ * frame starts as soon as possible.
+ */
+void sched_run_frame(void) {
+  TCNT1 = 0;
+
+  // Take note if the system timer (TIMER1) had an overflow
+  if (system_timer_overflow) {
+    statevars.status |= STATUS_SYS_TIMER_OVERFLOW;
+    system_timer_overflow = 0;
+  }
+
+  statevars.main_loop_counter = frame_count;
+
+  uint8_t i;
+  for (i = 0; i < task_count; i++) {
+    if (frames_until_release[i] != 0) {
+      frames_until_release[i]--;
+      continue;
+    }
+
+    frames_until_release[i] = task_table[i].period_frames - 1;
+
+    uint16_t start_ticks = TCNT1;
+    task_table[i].run();
+    uint16_t end_ticks = TCNT1;
+
+    record_task_ticks(i, end_ticks - start_ticks);
+
+    if (end_ticks > task_table[i].deadline_ticks) {
+      statevars.sched_overruns[i]++;
+      statevars.status |= STATUS_SCHED_OVERRUN;
+    }
+  }
+
+  uint16_t busy_ticks = TCNT1;
+  uint16_t slack_ticks = 0;
+
+  if (busy_ticks < SCHED_FRAME_TICKS) {
+    slack_ticks = SCHED_FRAME_TICKS - busy_ticks;
+  }
+
+  statevars.sched_frame_busy_ticks = busy_ticks;
+  statevars.sched_slack_ticks = slack_ticks;
+
+  if (slack_ticks < statevars.sched_min_slack_ticks) {
+    statevars.sched_min_slack_ticks = slack_ticks;
+  }
+
+  run_background_jobs();
+
+  uint16_t end_ticks = TCNT1;
+  if (end_ticks < SCHED_FRAME_TICKS) {
+    statevars.sched_idle_ticks = SCHED_FRAME_TICKS - end_ticks;
+  } else {
+    statevars.sched_idle_ticks = 0;
+  }
+
+  frame_count++;
+
+  while (1) {
+    // System timer reached 65,536
+    if (system_timer_overflow) {
+      break;
+    }
+
+    // Frame timer reached the end of the frame
+    if (TCNT1 >= SCHED_FRAME_TICKS) {
+      break;
+    }
+  }
+
+  return;
+}
+
+uint32_t sched_get_frame_count(void) {
+  return frame_count;
+}
+
+/* Adds a job to the background queue. Jobs must be posted from the main
+ * program (i.e., from a task or another job), never from an ISR.
+ * Returns 1 if the job was queued; 0 if the queue is full
+ */
+uint8_t sched_post_job(sched_job_fn step, uint16_t step_ticks) {
+  if (step == NULL || job_count == SCHED_MAX_JOBS) {
+    statevars.sched_jobs_dropped++;
+    return 0;
+  }
+
+  sched_job_t * job = &jobs[(job_head + job_count) % SCHED_MAX_JOBS];
+  job->step = step;
+  job->step_ticks = step_ticks;
+  job_count++;
+
+  return 1;
+}
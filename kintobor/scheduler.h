@@ -0,0 +1,84 @@
+/*
+ * file: scheduler.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Lists the types and functions used by the table-driven cooperative
+ * scheduler. The scheduler divides time into fixed-length minor frames that
+ * are clocked by Timer1. Every task declares how many frames apart it runs
+ * (its period), which frame it starts on (its offset), and how many timer
+ * ticks after the start of a frame it must be finished by (its deadline).
+ *
+ * Tasks run to completion in table order, so the table should be sorted by
+ * deadline (shortest deadline first). When every deadline equals its period
+ * this is the classic rate-monotonic priority assignment.
+ *
+ * Work that isn't tied to a rate can be posted as a background job instead,
+ * e.g., writing a record to the SD card one sector at a time, encoding
+ * telemetry for the serial port, or scanning the RAM for the stack's
+ * high-water mark (see ram.h). Background jobs run in the slack that is left
+ * at the end of a frame. A job does one bounded step of work per call and
+ * returns SCHED_JOB_MORE while it has more work to do, so long jobs are spread
+ * across as many frames as they need. A job that is waiting for something
+ * (e.g., room in the serial port's buffer) returns SCHED_JOB_WAIT instead, and
+ * isn't called again until the next frame.
+ *
+ * Every job step is timed. The longest step, the most a step ran past the
+ * duration its job declared, and the number of steps that ran past the end of
+ * the frame are kept in statevars, so the log shows whether the declared
+ * durations can be trusted.
+ *
+ * The extern "C" construct allows the main Arduino program to use the
+ * functions declared below.
+ */
+#ifndef _SCHEDULER_H_
+#define _SCHEDULER_H_
+
+#include <stdint.h>
+
+/* The SCHED_FRAME_TICKS value should be some fraction of:
+ * 16,000,000 / prescaler
+ * With a prescaler of 64, each Timer1 tick is 4 microseconds.
+ */
+#define SCHED_TICKS_PER_MS      250
+#define SCHED_FRAME_MS          10
+#define SCHED_FRAME_TICKS       (SCHED_FRAME_MS * SCHED_TICKS_PER_MS)
+#define SCHED_FRAMES_PER_SEC    (1000 / SCHED_FRAME_MS)
+#define SCHED_MAX_TASKS         8
+#define SCHED_MEAN_WEIGHT       16      // running mean uses 1/16 of each sample
+#define SCHED_MAX_JOBS          4
+
+typedef void (*sched_task_fn)(void);
+
+typedef struct {
+  sched_task_fn run;
+  uint8_t period_frames;    // run once every period_frames frames
+  uint8_t offset_frames;    // first frame in which the task runs
+  uint16_t deadline_ticks;  // must finish this many ticks into the frame
+} sched_task_t;
+
+// What a background job's step returns
+#define SCHED_JOB_DONE          0       // the job is done
+#define SCHED_JOB_MORE          1       // call again as soon as there's time
+#define SCHED_JOB_WAIT          2       // call again in the next frame
+
+typedef uint8_t (*sched_job_fn)(void);
+
+typedef struct {
+  sched_job_fn step;
+  uint16_t step_ticks;      // worst-case duration of a single step
+} sched_job_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif // #ifdef __cplusplus
+  uint8_t sched_init(const sched_task_t * tasks, uint8_t num_tasks);
+  void sched_start(void);
+  void sched_run_frame(void);
+  uint32_t sched_get_frame_count(void);
+  uint8_t sched_post_job(sched_job_fn step, uint16_t step_ticks);
+#ifdef __cplusplus
+}
+#endif // #ifdef __cplusplus
+
+#endif // #ifndef _SCHEDULER_H_
@@ -0,0 +1,167 @@
+/*
+ * file: sdcard.ino
+ * created: 20160906
+ * author(s): mr-augustine
+ *
+ * The sdcard Arduino file defines the SD card wrapper functions. Each record
+ * written is the most recently published statevars (see publish.h). The
+ * record is written by a background job, one SD card sector per step, and is
+ * released once its last sector has been written.
+ */
+#include <SD.h>
+#include "kintobor.h"
+
+#define SDCARD_CHIP_SELECT 53
+
+/* The SD library sends a whole, aligned sector straight from the record to
+ * the card, which takes about 1.3 ms at its 4 MHz SPI clock. The rest of a
+ * sector step's budget covers the card still being busy with the previous
+ * sector, and reading and updating the FAT when the file needs a new cluster.
+ * A flush rereads and rewrites the file's directory entry and writes back the
+ * FAT sector. Both budgets are estimates from the SPI clock: the job timing in
+ * the log (sched_job_max_ticks, sched_job_max_over_ticks, and
+ * sched_job_overruns; see tools/loop_report.py) shows what the card really
+ * takes. A card can stay busy for tens of milliseconds now and then while it
+ * erases a block; no step budget covers that, so such a step overruns its
+ * frame and is counted.
+ */
+#define SDCARD_SECTOR_STEP_TICKS  (4 * SCHED_TICKS_PER_MS)
+#define SDCARD_FLUSH_STEP_TICKS   (8 * SCHED_TICKS_PER_MS)
+
+// Flush the data file about once per second (the log task runs at 50 Hz)
+// so that a crash or power loss only costs us the most recent records
+#define SDCARD_FLUSH_RECORDS      50
+
+#define SDCARD_SECTORS_PER_RECORD (sizeof(statevars_t) / STATEVARS_SECTOR_SIZE)
+
+File data_file;
+uint8_t records_since_flush;
+
+// The next sector of the published record to write, and how many are left
+static const uint8_t * drain_next;
+static uint8_t drain_sectors_left;
+
+static uint8_t sdcard_drain_job(void);
+static uint8_t sdcard_flush_job(void);
+
+uint8_t sdcard_init(void) {
+  pinMode(SDCARD_CHIP_SELECT, OUTPUT);
+
+  if (!SD.begin(SDCARD_CHIP_SELECT)) {
+    uwrite_print_buff("SD Card didn't initialize\r\n");
+    return 0;
+  }
+
+  if (!init_datafile()) {
+    uwrite_print_buff("Could not start a new datafile\r\n");
+    return 0;
+  }
+
+  return 1;
+}
+
+uint8_t init_datafile(void) {
+  char filepath[32];
+
+  // Ensure that a folder with the same name as the robot is created
+  if (!SD.exists(ROBOT_NAME)) {
+    SD.mkdir(ROBOT_NAME);
+  }
+
+  // Create the path to the new file
+  // File names must be in the 8.3 format (i.e., 8 characters for the file name
+  // and 3 characters for the file extension)
+  uint16_t file_index;
+  for (file_index = 1; file_index < UINT16_MAX; file_index++) {
+    snprintf(filepath, sizeof(filepath), "/%s/k%05u.dat",
+              ROBOT_NAME, file_index);
+
+    if (!SD.exists(filepath)) {
+      data_file = SD.open(filepath, FILE_WRITE);
+      break;
+    }
+  }
+  if (file_index == UINT16_MAX) {
+    return 0;
+  }
+
+  if (!data_file) {
+    return 0;
+  }
+
+  uwrite_print_buff(filepath);
+  uwrite_print_buff(" was opened for write!\r\n");
+
+  return 1;
+}
+
+/* Starts writing the published record to the SD card in the background. The
+ * record is released right away if there's nothing to write it to.
+ */
+void write_data(void) {
+  drain_next = (const uint8_t *) statevars_published();
+  drain_sectors_left = SDCARD_SECTORS_PER_RECORD;
+
+  if (!data_file ||
+      !sched_post_job(sdcard_drain_job, SDCARD_SECTOR_STEP_TICKS)) {
+    drain_sectors_left = 0;
+    statevars_release();
+  }
+
+  return;
+}
+
+/* Background job that writes the next sector of the published record. After
+ * the last one it releases the record and, every SDCARD_FLUSH_RECORDS records,
+ * hands the flush to a job of its own, since the flush takes longer.
+ * Returns SCHED_JOB_MORE while sectors of the record are left to write
+ */
+static uint8_t sdcard_drain_job(void) {
+  if (drain_sectors_left == 0) {
+    return SCHED_JOB_DONE;
+  }
+
+  data_file.write(drain_next, STATEVARS_SECTOR_SIZE);
+  drain_next += STATEVARS_SECTOR_SIZE;
+  drain_sectors_left--;
+
+  if (drain_sectors_left > 0) {
+    return SCHED_JOB_MORE;
+  }
+
+  statevars_release();
+
+  records_since_flush++;
+  if (records_since_flush >= SDCARD_FLUSH_RECORDS) {
+    if (sched_post_job(sdcard_flush_job, SDCARD_FLUSH_STEP_TICKS)) {
+      records_since_flush = 0;
+    }
+  }
+
+  return SCHED_JOB_DONE;
+}
+
+/* Background job that commits the file size and the FAT to the SD card.
+ * Returns SCHED_JOB_DONE because the SD library flushes in a single call.
+ */
+static uint8_t sdcard_flush_job(void) {
+  if (data_file) {
+    data_file.flush();
+  }
+
+  return SCHED_JOB_DONE;
+}
+
+void sdcard_finish(void) {
+  if (data_file) {
+    // Finish the record that is being written; closing the file flushes it
+    while (drain_sectors_left > 0) {
+      sdcard_drain_job();
+    }
+
+    data_file.close();
+    uwrite_print_buff("File is closed\r\n");
+  }
+
+  return;
+}
@@ -0,0 +1,65 @@
+/*
+ * file: snapshot.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Defines a sequence counter (seqlock) for sharing multi-byte values between
+ * an ISR and the main program. The AVR reads and writes one byte at a time, so
+ * an interrupt that arrives in the middle of reading a 16- or 32-bit value
+ * can leave the reader with half of the old value and half of the new one.
+ *
+ * The ISR brackets its writes with snapshot_write_begin() and
+ * snapshot_write_end(), which make the counter odd and then even again. The
+ * main program copies the values between snapshot_read_begin() and
+ * snapshot_read_retry(), and copies them again if the counter changed in the
+ * meantime:
+ *
+ *   uint8_t seq;
+ *   do {
+ *     seq = snapshot_read_begin(&counter);
+ *     copy = shared;
+ *   } while (snapshot_read_retry(&counter, seq));
+ *
+ * Interrupts stay enabled the whole time, so a snapshot never delays another
+ * ISR (e.g., the GPS USART). Since an ISR runs to completion, the reader only
+ * ever has to retry once per interrupt that lands inside its copy.
+ *
+ * Every write section must begin and end within a single ISR call. A value
+ * that is built up over several interrupts should be assembled in a private
+ * variable and then published in one write section.
+ */
+#ifndef _SNAPSHOT_H_
+#define _SNAPSHOT_H_
+
+#include <stdint.h>
+
+typedef volatile uint8_t snapshot_seq_t;
+
+// Keeps the compiler from moving memory accesses across the counter updates
+#define SNAPSHOT_BARRIER() __asm__ __volatile__ ("" ::: "memory")
+
+static inline void snapshot_write_begin(snapshot_seq_t * seq) {
+  *seq = *seq + 1;
+  SNAPSHOT_BARRIER();
+}
+
+static inline void snapshot_write_end(snapshot_seq_t * seq) {
+  SNAPSHOT_BARRIER();
+  *seq = *seq + 1;
+}
+
+static inline uint8_t snapshot_read_begin(const snapshot_seq_t * seq) {
+  uint8_t start = *seq;
+  SNAPSHOT_BARRIER();
+
+  return start;
+}
+
+// Returns 1 if the values copied since snapshot_read_begin() may be torn
+static inline uint8_t snapshot_read_retry(const snapshot_seq_t * seq, uint8_t start) {
+  SNAPSHOT_BARRIER();
+
+  return ((start & 1) != 0) || (*seq != start);
+}
+
+#endif // #ifndef _SNAPSHOT_H_
@@ -0,0 +1,298 @@
+/*
+ * file: statevars.h
+ * created: 20160906
+ * author(s): mr-augustine
+ *
+ * This statevars header file defines the data structure that stores the
+ * parsed GPS values. It also defines the status bits which are used to
+ * indicate state information about the GPS sensor.
+ *
+ * Each feature's fields are only part of the record when the sketch is built
+ * with that feature (see kintobor_features.h). tools/statevars.py reads the
+ * sketch's own statevars.h, so it knows which fields a sketch's records have.
+ *
+ * The fields are grouped by how often they are used, in this order:
+ *   header      prefix, status, and the loop counter
+ *   hot         navigation, control, and mobility; used by the control loop
+ *               every few frames, so they are kept together at the front
+ *   sensors     the values parsed or read from each sensor, with its metadata
+ *   scheduler   per-task timing statistics, RAM use (see ram.h), how long
+ *               the boot took (see boot.h), and records that couldn't be
+ *               published (see publish.h)
+ *   raw         raw compass axes and GPS sentences, only used when debugging
+ *   padding     fills the record up to a whole number of SD card sectors;
+ *               left out when there is nothing to fill, since a zero-length
+ *               array is neither C nor C++
+ *   suffix
+ * Every group is a multiple of 4 bytes long and lists its 4-byte fields
+ * first, so every field is naturally aligned and the record has the same
+ * layout on the AVR (which packs structs) and on the host (which aligns them).
+ *
+ * In a sketch that logs to the SD card, a record is always a whole number of
+ * STATEVARS_SECTOR_SIZE sectors, so every record written to the card starts
+ * and ends on a sector boundary and no sector is ever partly overwritten.
+ * Other sketches don't pad their records. All four GPS sentences are logged
+ * raw, so a record with the GPS takes two sectors. A sketch that can do
+ * without the raw GPGSA and GPVTG sentences can set
+ * STATEVARS_ALL_GPS_SENTENCES to 0 in its kintobor_config.h; its records then
+ * leave those two fields out, and a full-featured record fits one sector.
+ * tools/statevars.py reads the setting along with the rest. The asserts at the
+ * bottom of the file stop the build if a field is added without updating the
+ * group sizes.
+ */
+#ifndef _STATEVARS_H_
+#define _STATEVARS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "kintobor_features.h"
+#include "sample.h"
+#include "scheduler.h"
+
+#define GPS_SENTENCE_LENGTH   84
+#define GPS_DATE_WIDTH        8
+
+// 0 leaves the raw GPGSA and GPVTG sentences out of the record
+#ifndef STATEVARS_ALL_GPS_SENTENCES
+#define STATEVARS_ALL_GPS_SENTENCES 1
+#endif
+
+#define STATEVARS_GPS_SENTENCES   (2 + 2 * STATEVARS_ALL_GPS_SENTENCES)
+#define STATEVARS_SECTOR_SIZE     512
+
+// The size of each group of fields; a feature that is left out takes up none
+#define STATEVARS_HEADER_BYTES    12
+#define STATEVARS_NAV_BYTES       (KINTOBOR_WITH_NAV * 40)
+#define STATEVARS_CONTROL_BYTES   (KINTOBOR_WITH_CONTROL * 20)
+#define STATEVARS_MOBILITY_BYTES  (KINTOBOR_WITH_MOBILITY * 12)
+#define STATEVARS_GPS_BYTES       (KINTOBOR_WITH_GPS * 80)
+#define STATEVARS_COMPASS_BYTES   (KINTOBOR_WITH_COMPASS * 24)
+#define STATEVARS_ODOMETER_BYTES  (KINTOBOR_WITH_ODOMETER * 20)
+#define STATEVARS_SCHED_BYTES     (5 * 2 * SCHED_MAX_TASKS + 24)
+#define STATEVARS_RAW_BYTES       (KINTOBOR_WITH_COMPASS * 12 + \
+                                   KINTOBOR_WITH_GPS * \
+                                   STATEVARS_GPS_SENTENCES * GPS_SENTENCE_LENGTH)
+#define STATEVARS_SUFFIX_BYTES    4
+
+// Where each group starts
+#define STATEVARS_NAV_OFFSET      STATEVARS_HEADER_BYTES
+#define STATEVARS_CONTROL_OFFSET  (STATEVARS_NAV_OFFSET + STATEVARS_NAV_BYTES)
+#define STATEVARS_MOBILITY_OFFSET (STATEVARS_CONTROL_OFFSET + \
+                                   STATEVARS_CONTROL_BYTES)
+#define STATEVARS_GPS_OFFSET      (STATEVARS_MOBILITY_OFFSET + \
+                                   STATEVARS_MOBILITY_BYTES)
+#define STATEVARS_COMPASS_OFFSET  (STATEVARS_GPS_OFFSET + STATEVARS_GPS_BYTES)
+#define STATEVARS_ODOMETER_OFFSET (STATEVARS_COMPASS_OFFSET + \
+                                   STATEVARS_COMPASS_BYTES)
+#define STATEVARS_SCHED_OFFSET    (STATEVARS_ODOMETER_OFFSET + \
+                                   STATEVARS_ODOMETER_BYTES)
+#define STATEVARS_RAW_OFFSET      (STATEVARS_SCHED_OFFSET + \
+                                   STATEVARS_SCHED_BYTES)
+
+#define STATEVARS_USED_BYTES      (STATEVARS_RAW_OFFSET + STATEVARS_RAW_BYTES + \
+                                   STATEVARS_SUFFIX_BYTES)
+#if KINTOBOR_WITH_SDCARD
+#define STATEVARS_RECORD_SIZE     ((STATEVARS_USED_BYTES + \
+                                    STATEVARS_SECTOR_SIZE - 1) / \
+                                   STATEVARS_SECTOR_SIZE * \
+                                   STATEVARS_SECTOR_SIZE)
+#else
+#define STATEVARS_RECORD_SIZE     STATEVARS_USED_BYTES
+#endif
+#define STATEVARS_PADDING_BYTES   (STATEVARS_RECORD_SIZE - STATEVARS_USED_BYTES)
+
+#define STATUS_SYS_TIMER_OVERFLOW (1 << 0)
+#define STATUS_MISSION_ACTIVE     (1 << 1)
+#define STATUS_GPS_NO_BUFF_AVAIL  (1 << 2)
+#define STATUS_GPS_BUFF_OVERFLOW  (1 << 3)
+#define STATUS_GPS_UNEXPECT_START (1 << 4)
+#define STATUS_GPS_GPGGA_RCVD     (1 << 5)
+#define STATUS_GPS_GPVTG_RCVD     (1 << 6)
+#define STATUS_GPS_GPRMC_RCVD     (1 << 7)
+#define STATUS_GPS_GPGSA_RCVD     (1 << 8)
+#define STATUS_GPS_NO_FIX_AVAIL   (1 << 9)
+#define STATUS_GPS_UNEXPECT_VAL   (1 << 10)
+#define STATUS_GPS_DATA_NOT_VALID (1 << 11)
+#define STATUS_SCHED_OVERRUN      (1 << 12)
+#define STATUS_GPS_FIX_AVAIL      (1 << 13)
+#define STATUS_NAV_POSITION_KNOWN (1 << 14)
+
+typedef struct {
+    // header
+    uint32_t  prefix;
+    uint32_t  status;
+    uint32_t  main_loop_counter;
+    // hot
+#if KINTOBOR_WITH_NAV
+    uint32_t  nav_timestamp;
+    float     nav_heading_deg;
+    float     nav_gps_heading;
+    float     nav_latitude;
+    float     nav_longitude;
+    float     nav_waypt_latitude;
+    float     nav_waypt_longitude;
+    float     nav_rel_bearing_deg;
+    float     nav_distance_to_waypt_m;
+    float     nav_speed;
+#endif // #if KINTOBOR_WITH_NAV
+#if KINTOBOR_WITH_CONTROL
+    float     control_heading_desired;
+    float     control_xtrack_error;
+    float     control_xtrack_error_rate;
+    float     control_xtrack_error_sum;
+    float     control_steering_pwm;
+#endif // #if KINTOBOR_WITH_CONTROL
+#if KINTOBOR_WITH_MOBILITY
+    uint16_t  mobility_motor_pwm;
+    uint16_t  mobility_steering_pwm;
+    uint16_t  cruise_target_mmps;
+    int16_t   cruise_error_mmps;
+    int16_t   cruise_feedforward_us;
+    int16_t   cruise_integral_us;
+#endif // #if KINTOBOR_WITH_MOBILITY
+    // sensors
+#if KINTOBOR_WITH_GPS
+    sample_meta_t gps_meta;
+    float     gps_latitude;
+    float     gps_longitude;
+    float     gps_lat_ddeg;
+    float     gps_long_ddeg;
+    float     gps_hdop;
+    float     gps_pdop;
+    float     gps_vdop;
+    float     gps_msl_altitude_m;
+    float     gps_true_hdg_deg;
+    float     gps_ground_course_deg;
+    float     gps_speed_kmph;
+    float     gps_ground_speed_kt;
+    float     gps_speed_kt;
+    float     gps_seconds;
+    uint16_t  gps_lat_deg;
+    uint16_t  gps_long_deg;
+    char      gps_date[GPS_DATE_WIDTH];
+    uint8_t   gps_hours;
+    uint8_t   gps_minutes;
+    uint8_t   gps_satcount;
+    uint8_t   gps_reserved;
+#endif // #if KINTOBOR_WITH_GPS
+#if KINTOBOR_WITH_COMPASS
+    sample_meta_t compass_meta;
+    float     heading_deg;
+    uint16_t  heading_raw;
+    uint16_t  compass_bus_us;
+    int8_t    pitch_deg;
+    int8_t    roll_deg;
+    uint8_t   compass_samples;
+    uint8_t   twi_nacks;
+    uint8_t   twi_bus_errors;
+    uint8_t   twi_timeouts;
+    uint8_t   compass_reserved[2];
+#endif // #if KINTOBOR_WITH_COMPASS
+#if KINTOBOR_WITH_ODOMETER
+    sample_meta_t odometer_meta;
+    uint32_t  odometer_ticks;
+    uint32_t  odometer_speed_span;
+    uint16_t  odometer_speed_mmps;
+    uint8_t   odometer_ticks_are_fwd;
+    uint8_t   odometer_speed_periods;
+#endif // #if KINTOBOR_WITH_ODOMETER
+    // scheduler
+    uint16_t  sched_overruns[SCHED_MAX_TASKS];
+    uint16_t  sched_task_runs[SCHED_MAX_TASKS];
+    uint16_t  sched_task_ticks[SCHED_MAX_TASKS];
+    uint16_t  sched_task_max_ticks[SCHED_MAX_TASKS];
+    uint16_t  sched_task_mean_ticks[SCHED_MAX_TASKS];
+    uint16_t  sched_frame_busy_ticks;
+    uint16_t  sched_slack_ticks;
+    uint16_t  sched_min_slack_ticks;
+    uint16_t  sched_idle_ticks;
+    uint16_t  sched_jobs_done;
+    uint16_t  ram_stack_peak;
+    uint16_t  ram_free_min;
+    uint16_t  boot_ms;
+    uint16_t  sched_job_max_ticks;
+    uint16_t  sched_job_max_over_ticks;
+    uint8_t   boot_not_ready;
+    uint8_t   sched_jobs_dropped;
+    uint8_t   sched_job_overruns;
+    uint8_t   publish_skipped;
+    // raw
+#if KINTOBOR_WITH_COMPASS
+    int16_t   compass_mag[3];
+    int16_t   compass_accel[3];
+#endif // #if KINTOBOR_WITH_COMPASS
+#if KINTOBOR_WITH_GPS
+    char      gps_sentence0[GPS_SENTENCE_LENGTH];   // GPGGA
+#if STATEVARS_ALL_GPS_SENTENCES
+    char      gps_sentence1[GPS_SENTENCE_LENGTH];   // GPGSA
+#endif // #if STATEVARS_ALL_GPS_SENTENCES
+    char      gps_sentence2[GPS_SENTENCE_LENGTH];   // GPRMC
+#if STATEVARS_ALL_GPS_SENTENCES
+    char      gps_sentence3[GPS_SENTENCE_LENGTH];   // GPVTG
+#endif // #if STATEVARS_ALL_GPS_SENTENCES
+#endif // #if KINTOBOR_WITH_GPS
+#if STATEVARS_PADDING_BYTES > 0
+    uint8_t   padding[STATEVARS_PADDING_BYTES];
+#endif // #if STATEVARS_PADDING_BYTES > 0
+    uint32_t suffix;
+} statevars_t;
+
+// Checks the layout described at the top of the file
+#ifdef __cplusplus
+#define STATEVARS_ASSERT(cond, msg) static_assert(cond, msg)
+#else
+#define STATEVARS_ASSERT(cond, msg) _Static_assert(cond, msg)
+#endif
+
+STATEVARS_ASSERT(sizeof(sample_meta_t) == 8, "sample_meta_t is not 8 bytes");
+STATEVARS_ASSERT(STATEVARS_SCHED_BYTES % 4 == 0,
+                 "SCHED_MAX_TASKS must be even");
+#if KINTOBOR_WITH_NAV
+STATEVARS_ASSERT(offsetof(statevars_t, nav_timestamp) == STATEVARS_NAV_OFFSET,
+                 "nav_timestamp is not at STATEVARS_NAV_OFFSET");
+#endif
+#if KINTOBOR_WITH_CONTROL
+STATEVARS_ASSERT(offsetof(statevars_t, control_heading_desired) ==
+                 STATEVARS_CONTROL_OFFSET,
+                 "control_heading_desired is not at STATEVARS_CONTROL_OFFSET");
+#endif
+#if KINTOBOR_WITH_MOBILITY
+STATEVARS_ASSERT(offsetof(statevars_t, mobility_motor_pwm) ==
+                 STATEVARS_MOBILITY_OFFSET,
+                 "mobility_motor_pwm is not at STATEVARS_MOBILITY_OFFSET");
+#endif
+#if KINTOBOR_WITH_GPS
+STATEVARS_ASSERT(offsetof(statevars_t, gps_meta) == STATEVARS_GPS_OFFSET,
+                 "gps_meta is not at STATEVARS_GPS_OFFSET");
+#endif
+#if KINTOBOR_WITH_COMPASS
+STATEVARS_ASSERT(offsetof(statevars_t, compass_meta) ==
+                 STATEVARS_COMPASS_OFFSET,
+                 "compass_meta is not at STATEVARS_COMPASS_OFFSET");
+#endif
+#if KINTOBOR_WITH_ODOMETER
+STATEVARS_ASSERT(offsetof(statevars_t, odometer_meta) ==
+                 STATEVARS_ODOMETER_OFFSET,
+                 "odometer_meta is not at STATEVARS_ODOMETER_OFFSET");
+#endif
+STATEVARS_ASSERT(offsetof(statevars_t, sched_overruns) ==
+                 STATEVARS_SCHED_OFFSET,
+                 "sched_overruns is not at STATEVARS_SCHED_OFFSET");
+STATEVARS_ASSERT(offsetof(statevars_t, suffix) ==
+                 STATEVARS_RAW_OFFSET + STATEVARS_RAW_BYTES +
+                 STATEVARS_PADDING_BYTES,
+                 "the suffix does not follow the raw fields and padding");
+STATEVARS_ASSERT(offsetof(statevars_t, suffix) ==
+                 STATEVARS_RECORD_SIZE - STATEVARS_SUFFIX_BYTES,
+                 "the suffix is not at the end of the record");
+STATEVARS_ASSERT(sizeof(statevars_t) == STATEVARS_RECORD_SIZE,
+                 "statevars_t is not STATEVARS_RECORD_SIZE bytes");
+#if KINTOBOR_WITH_SDCARD
+STATEVARS_ASSERT(sizeof(statevars_t) % STATEVARS_SECTOR_SIZE == 0,
+                 "statevars_t does not fill whole SD card sectors");
+#endif
+
+extern statevars_t statevars;
+
+#endif // #ifndef _STATEVARS_H_
@@ -0,0 +1,74 @@
+/*
+ * file: timebase.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Defines the free-running 32-bit timebase built on Timer5. The lower 16 bits
+ * come from the timer itself and the upper 16 bits are counted by the overflow
+ * interrupt.
+ */
+
+#include "hal.h"
+#include "timebase.h"
+
+// Upper 16 bits of the timebase
+static volatile uint16_t overflow_count;
+
+// Interrupt Service Routine that triggers each time Timer5 wraps around
+ISR(TIMER5_OVF_vect) {
+  overflow_count++;
+}
+
+/* Configures Timer5 to count freely with a prescaler of 64. The input capture
+ * unit is left for the odometer to configure; see odometer.c.
+ * See Atmel datasheet for Mega, Section 17.11
+ */
+void timebase_init(void) {
+  uint8_t sreg = SREG;
+  cli();
+
+  TCCR5A = 0b00000000;  // Normal operation; no output compare pins
+  TCCR5B = 0b00000000;  // Stop the timer while we set it up
+  TCCR5C = 0b00000000;
+
+  TCNT5 = 0;
+  overflow_count = 0;
+
+  TIFR5 = (1 << TOV5);
+  TIMSK5 |= (1 << TOIE5);
+
+  TCCR5B |= (1 << CS51) | (1 << CS50); // prescaler = 64
+
+  SREG = sreg;
+
+  return;
+}
+
+/* Returns the 32-bit timestamp for a 16-bit Timer5 value (e.g., a captured
+ * value) that was taken within the last half of a timer period. Must be called
+ * with interrupts disabled, which is always the case inside an ISR.
+ *
+ * If Timer5 overflowed but its overflow ISR hasn't run yet, a small count
+ * belongs after the pending overflow while a large count was taken before it.
+ */
+uint32_t timebase_extend(uint16_t count) {
+  uint16_t upper = overflow_count;
+
+  if ((TIFR5 & (1 << TOV5)) && count < 0x8000) {
+    upper++;
+  }
+
+  return ((uint32_t) upper << 16) | count;
+}
+
+// Returns the current time in timebase ticks (4 microseconds per tick)
+uint32_t timebase_now(void) {
+  uint8_t sreg = SREG;
+  cli();
+
+  uint32_t now = timebase_extend(TCNT5);
+
+  SREG = sreg;
+
+  return now;
+}
@@ -0,0 +1,41 @@
+/*
+ * file: timebase.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Lists the functions used to read the free-running system timebase. Timer5
+ * counts continuously with a prescaler of 64 (4 microseconds per tick) and is
+ * never reset. Its overflow interrupt extends the 16-bit count to 32 bits, so
+ * the timebase wraps around only once every 4.77 hours.
+ *
+ * Timer5's input capture unit latches the count in hardware when its pin
+ * (ICP5) changes. A capture ISR can turn the latched value into a full 32-bit
+ * timestamp with timebase_extend().
+ *
+ * The extern "C" construct allows the main Arduino program to use the
+ * functions declared below.
+ */
+#ifndef _TIMEBASE_H_
+#define _TIMEBASE_H_
+
+#include <stdint.h>
+
+#include "hal.h"
+
+#define TIMEBASE_TICKS_PER_MS       250
+#define TIMEBASE_US_PER_TICK        4
+
+#define TIMEBASE_CAPTURE_REG        ICR5
+#define TIMEBASE_CAPTURE_ISR_VECT   TIMER5_CAPT_vect
+
+#ifdef __cplusplus
+extern "C" {
+#endif // #ifdef __cplusplus
+  void timebase_init(void);
+  uint32_t timebase_now(void);
+  uint32_t timebase_extend(uint16_t count);
+#ifdef __cplusplus
+}
+#endif // #ifdef __cplusplus
+
+#endif // #ifndef _TIMEBASE_H_
@@ -0,0 +1,283 @@
+/*
+ * file: twi_master.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Defines the interrupt-driven TWI (I2C) master. Submitted transactions wait
+ * in a small queue. The transaction at the head of the queue is the one on the
+ * bus; every TWI interrupt advances it by one step:
+ *
+ *   START -> SLA+W -> write bytes -> REPEATED START -> SLA+R -> read bytes
+ *
+ * The write or read half is skipped when its length is zero. When a
+ * transaction finishes (or fails), the next one is started with a STOP
+ * followed immediately by a START, so queued transactions run back to back
+ * without waiting for the main program.
+ *
+ * A device that stops responding in the middle of a transaction could stall
+ * the bus forever, so twi_poll() resets the TWI hardware and fails the
+ * transaction once it has been on the bus longer than TWI_TIMEOUT_TICKS.
+ *
+ * A transaction submitted while the bus is idle starts right away, unless the
+ * previous STOP is still being sent (e.g., because a slave holds SCL low).
+ * Rather than wait for it with interrupts disabled, twi_poll() sends the START
+ * once the STOP is out, and fails the transaction with Twi_Error_Bus if the
+ * STOP doesn't go out within TWI_TIMEOUT_TICKS.
+ */
+#include <stddef.h>
+
+#include "hal.h"
+#include "statevars.h"
+#include "timebase.h"
+#include "twi.h"
+#include "twi_master.h"
+
+// Clears TWINT to continue; the ACK bit controls the reply to the next byte
+#define TWCR_NACK       ((1 << TWINT) | (1 << TWEN) | (1 << TWIE))
+#define TWCR_ACK        (TWCR_NACK | (1 << TWEA))
+#define TWCR_START      (TWCR_NACK | (1 << TWSTA))
+#define TWCR_STOP       (TWCR_NACK | (1 << TWSTO))
+
+static twi_txn_t * volatile queue[TWI_QUEUE_SIZE];
+static volatile uint8_t queue_head;     // the transaction on the bus
+static volatile uint8_t queue_count;
+
+static volatile uint8_t write_pos;
+static volatile uint8_t read_pos;
+static volatile uint32_t started_at;    // timebase ticks
+static volatile uint8_t start_deferred; // the START waits for the STOP
+
+static void begin(twi_txn_t * txn);
+static void finish(uint8_t status, uint8_t twcr);
+
+ISR(TWI_vect) {
+  if (queue_count == 0) {
+    // Nothing should be on the bus; let go of it
+    TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWSTO);
+    return;
+  }
+
+  twi_txn_t * txn = queue[queue_head];
+
+  switch (TW_STATUS) {
+    // Address the slave; we write first unless there is only reading to do
+    case TW_START:
+    case TW_REP_START:
+      if (write_pos < txn->write_len || txn->read_len == 0) {
+        TWDR = (txn->address << 1) | TW_WRITE;
+      } else {
+        TWDR = (txn->address << 1) | TW_READ;
+      }
+      TWCR = TWCR_NACK;
+      break;
+
+    // Send the next byte, switch over to reading, or finish
+    case TW_MT_SLA_ACK:
+    case TW_MT_DATA_ACK:
+      if (write_pos < txn->write_len) {
+        TWDR = txn->write_data[write_pos++];
+        TWCR = TWCR_NACK;
+      } else if (txn->read_len > 0) {
+        TWCR = TWCR_START;
+      } else {
+        finish(Twi_Done, TWCR_STOP);
+      }
+      break;
+
+    // ACK every byte except the last one
+    case TW_MR_SLA_ACK:
+      TWCR = (txn->read_len > 1) ? TWCR_ACK : TWCR_NACK;
+      break;
+
+    case TW_MR_DATA_ACK:
+      txn->read_data[read_pos++] = TWDR;
+      TWCR = (read_pos + 1 < txn->read_len) ? TWCR_ACK : TWCR_NACK;
+      break;
+
+    case TW_MR_DATA_NACK:
+      if (read_pos < txn->read_len) {
+        txn->read_data[read_pos++] = TWDR;
+      }
+      finish(Twi_Done, TWCR_STOP);
+      break;
+
+    case TW_MT_SLA_NACK:
+    case TW_MT_DATA_NACK:
+    case TW_MR_SLA_NACK:
+      finish(Twi_Error_Nack, TWCR_STOP);
+      break;
+
+    // Another master took the bus; release it and try the next transaction
+    // once the bus is free again
+    case TW_MT_ARB_LOST:
+      finish(Twi_Error_Bus, TWCR_NACK);
+      break;
+
+    // An illegal START or STOP; a STOP with TWINT set releases the bus
+    // without actually sending the STOP
+    case TW_BUS_ERROR:
+    default:
+      finish(Twi_Error_Bus, TWCR_STOP);
+      break;
+  }
+}
+
+// Prepares the transaction at the head of the queue to go on the bus
+static void begin(twi_txn_t * txn) {
+  txn->status = Twi_Busy;
+  write_pos = 0;
+  read_pos = 0;
+  started_at = timebase_now();
+
+  return;
+}
+
+/* Completes the transaction at the head of the queue and writes twcr, which
+ * ends it on the bus. If another transaction is waiting, a START is added to
+ * twcr so that it begins right away. Runs with interrupts disabled.
+ */
+static void finish(uint8_t status, uint8_t twcr) {
+  twi_txn_t * txn = queue[queue_head];
+
+  queue_head = (queue_head + 1) % TWI_QUEUE_SIZE;
+  queue_count--;
+
+  switch (status) {
+    case Twi_Error_Nack:
+      statevars.twi_nacks++;
+      break;
+    case Twi_Error_Bus:
+      statevars.twi_bus_errors++;
+      break;
+    case Twi_Error_Timeout:
+      statevars.twi_timeouts++;
+      break;
+    default:
+      ;
+  }
+
+  txn->finished_at = timebase_now();
+
+  uint32_t bus_ticks = txn->finished_at - started_at;
+  txn->bus_ticks = (bus_ticks > UINT16_MAX) ? UINT16_MAX : bus_ticks;
+
+  txn->status = status;
+  if (txn->done != NULL) {
+    txn->done(txn);
+  }
+
+  if (queue_count > 0) {
+    begin(queue[queue_head]);
+    twcr |= (1 << TWSTA);
+  }
+
+  TWCR = twcr;
+
+  return;
+}
+
+/* Sets the SCL clock frequency (e.g., TWI_FREQ_STANDARD or TWI_FREQ_FAST) and
+ * enables the TWI and its interrupt.
+ * Returns 1 if the frequency can be generated; 0 otherwise
+ */
+uint8_t twi_init(uint32_t bus_freq_hz) {
+  // With a prescaler of 1, SCL = F_CPU / (16 + 2 * TWBR)
+  // See Section 22.5.2 in the Atmel Specsheet
+  if (bus_freq_hz == 0 || bus_freq_hz > F_CPU / 16) {
+    return 0;
+  }
+
+  uint32_t bit_rate = (F_CPU / bus_freq_hz - 16) / 2;
+
+  if (bit_rate > UINT8_MAX) {
+    return 0;
+  }
+
+  queue_head = 0;
+  queue_count = 0;
+  start_deferred = 0;
+
+  statevars.twi_nacks = 0;
+  statevars.twi_bus_errors = 0;
+  statevars.twi_timeouts = 0;
+
+  TWSR = 0;     // prescaler = 1
+  TWBR = bit_rate;
+
+  TWCR = (1 << TWEN) | (1 << TWIE);
+
+  return 1;
+}
+
+/* Adds a transaction to the queue and starts it if the bus is idle.
+ * Returns 1 if the transaction was queued; 0 if the queue is full or the
+ * transaction is already queued
+ */
+uint8_t twi_submit(twi_txn_t * txn) {
+  if (txn == NULL || txn->status == Twi_Pending || txn->status == Twi_Busy) {
+    return 0;
+  }
+
+  uint8_t sreg = SREG;
+  cli();
+
+  if (queue_count == TWI_QUEUE_SIZE) {
+    SREG = sreg;
+    return 0;
+  }
+
+  txn->status = Twi_Pending;
+  queue[(queue_head + queue_count) % TWI_QUEUE_SIZE] = txn;
+  queue_count++;
+
+  if (queue_count == 1) {
+    begin(txn);
+
+    // The START has to wait until the previous STOP is out
+    if (TWCR & (1 << TWSTO)) {
+      start_deferred = 1;
+    } else {
+      TWCR = TWCR_START;
+    }
+  }
+
+  SREG = sreg;
+
+  return 1;
+}
+
+// Returns 1 if the transaction is no longer owned by the TWI master
+uint8_t twi_txn_is_finished(const twi_txn_t * txn) {
+  uint8_t status = txn->status;
+
+  return (status != Twi_Pending && status != Twi_Busy);
+}
+
+/* Sends a START that twi_submit() had to hold back once the previous STOP is
+ * out, and fails the transaction on the bus if it has taken too long.
+ * Resetting the TWI hardware releases the bus; the next queued transaction
+ * (if any) then starts from scratch. Device drivers should call this from
+ * their update functions.
+ */
+void twi_poll(void) {
+  uint8_t sreg = SREG;
+  cli();
+
+  if (start_deferred && !(TWCR & (1 << TWSTO))) {
+    start_deferred = 0;
+    TWCR = TWCR_START;
+  }
+
+  if (queue_count > 0 && timebase_now() - started_at > TWI_TIMEOUT_TICKS) {
+    // A STOP that never went out means the bus itself is stuck
+    uint8_t status = start_deferred ? Twi_Error_Bus : Twi_Error_Timeout;
+    start_deferred = 0;
+
+    TWCR = 0;
+    finish(status, (1 << TWINT) | (1 << TWEN) | (1 << TWIE));
+  }
+
+  SREG = sreg;
+
+  return;
+}
@@ -0,0 +1,69 @@
+/*
+ * file: twi_master.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Lists the types and functions used by the interrupt-driven Two-Wire
+ * Interface (TWI/I2C) master. Devices describe each bus operation with a
+ * transaction: the slave address, the bytes to write (usually a register
+ * address), and the number of bytes to read back. Transactions are queued and
+ * run back to back by the TWI ISR, so a device driver only has to submit a
+ * transaction and check on it later.
+ *
+ * A transaction (and its buffers) belongs to the TWI master from the time it
+ * is submitted until its status is no longer Twi_Pending or Twi_Busy. The
+ * optional callback runs inside the TWI ISR when the transaction finishes, so
+ * it must be short.
+ *
+ * The extern "C" construct allows the main Arduino program to use the
+ * functions declared below.
+ */
+#ifndef _TWI_MASTER_H_
+#define _TWI_MASTER_H_
+
+#include <stdint.h>
+
+#include "timebase.h"
+
+#define TWI_QUEUE_SIZE        4
+#define TWI_FREQ_STANDARD     100000UL  // standard mode
+#define TWI_FREQ_FAST         400000UL  // fast mode
+#define TWI_TIMEOUT_TICKS     (5UL * TIMEBASE_TICKS_PER_MS)
+
+typedef enum {
+  Twi_Idle,             // never submitted
+  Twi_Pending,          // waiting in the queue
+  Twi_Busy,             // on the bus
+  Twi_Done,             // finished; the read buffer is filled in
+  Twi_Error_Nack,       // the slave didn't acknowledge
+  Twi_Error_Bus,        // bus error or lost arbitration
+  Twi_Error_Timeout     // didn't finish within TWI_TIMEOUT_TICKS
+} Twi_Status;
+
+struct twi_txn;
+typedef void (*twi_callback_fn)(struct twi_txn * txn);
+
+typedef struct twi_txn {
+  uint8_t address;              // 7-bit slave address
+  const uint8_t * write_data;
+  uint8_t write_len;
+  uint8_t * read_data;
+  uint8_t read_len;
+  twi_callback_fn done;         // may be NULL
+  volatile uint8_t status;      // one of Twi_Status
+  uint16_t bus_ticks;           // timebase ticks spent on the bus last time
+  uint32_t finished_at;         // timebase ticks when it last finished
+} twi_txn_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif // #ifdef __cplusplus
+  uint8_t twi_init(uint32_t bus_freq_hz);
+  uint8_t twi_submit(twi_txn_t * txn);
+  uint8_t twi_txn_is_finished(const twi_txn_t * txn);
+  void twi_poll(void);
+#ifdef __cplusplus
+}
+#endif // #ifdef __cplusplus
+
+#endif // #ifndef _TWI_MASTER_H_
@@ -0,0 +1,96 @@
+/*
+ * file: SD.cpp
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * The SD library stand-in's SPI traffic. File::write() sends each whole
+ * sector the way the library's Sd2Card::writeBlock() does: CMD24 with the
+ * block number, the data start token, the 512 bytes one SPI transfer at a
+ * time, a dummy CRC, the card's data response, and a CMD13 status check. The
+ * library writes a whole, aligned sector straight from the caller's buffer
+ * like this, without its block cache.
+ *
+ * Every wait for the card takes a single byte, as if the card were never
+ * busy, and the FAT updates the library makes when the file needs another
+ * cluster are left out. The card's own time shows up in the robot's logs
+ * (see sdcard.ino), not here.
+ */
+#include "hal.h"
+#include "SD.h"
+
+#define SD_CMD13            13      // SEND_STATUS
+#define SD_CMD24            24      // WRITE_BLOCK
+#define SD_DATA_START_TOKEN 0xFE
+#define SD_SECTOR_SIZE      512
+#define SD_CS_PIN           PB0     // Mega Digital Pin 53
+
+SDClass SD;
+
+static uint8_t spi_transfer(uint8_t data) {
+  SPDR = data;
+  while (!(SPSR & (1 << SPIF))) {
+    // Wait for the byte to be shifted out
+  }
+
+  return SPDR;
+}
+
+// Sends a command the way Sd2Card::cardCommand() does; returns the response
+static uint8_t card_command(uint8_t command, uint32_t arg) {
+  int8_t shift;
+
+  spi_transfer(0xFF);   // the card is ready
+  spi_transfer(command | 0x40);
+  for (shift = 24; shift >= 0; shift -= 8) {
+    spi_transfer(arg >> shift);
+  }
+  spi_transfer(0xFF);   // the CRC is only checked for CMD0 and CMD8
+
+  return spi_transfer(0xFF);
+}
+
+// Sets up the SPI bus as the library does: master, mode 0, F_CPU / 4
+bool SDClass::begin(uint8_t cs_pin) {
+  PORTB |= (1 << SD_CS_PIN);
+  DDRB |= (1 << SD_CS_PIN) | (1 << PB1) | (1 << PB2);   // SS, SCK, MOSI
+  SPCR = (1 << SPE) | (1 << MSTR);
+  SPSR = 0;
+
+  return true;
+}
+
+/* Writes the whole sectors in data, one block each. sdcard.ino never writes
+ * anything but whole sectors. Returns the number of bytes written
+ */
+size_t File::write(const uint8_t * data, size_t size) {
+  size_t written = 0;
+
+  while (is_open && size - written >= SD_SECTOR_SIZE) {
+    uint16_t i;
+
+    PORTB &= ~(1 << SD_CS_PIN);
+
+    card_command(SD_CMD24, block);
+
+    spi_transfer(SD_DATA_START_TOKEN);
+    for (i = 0; i < SD_SECTOR_SIZE; i++) {
+      spi_transfer(data[written + i]);
+    }
+    spi_transfer(0xFF);
+    spi_transfer(0xFF);
+    spi_transfer(0xFF);   // the data response
+
+    spi_transfer(0xFF);   // the card has finished programming the block
+
+    // The status is two bytes
+    card_command(SD_CMD13, 0);
+    spi_transfer(0xFF);
+
+    PORTB |= (1 << SD_CS_PIN);
+
+    block++;
+    written += SD_SECTOR_SIZE;
+  }
+
+  return written;
+}
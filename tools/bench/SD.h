@@ -0,0 +1,52 @@
+/*
+ * file: SD.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Stands in for the Arduino SD library when sdcard.ino is built into the
+ * benchmarks. There is no card on simavr's SPI bus, so the library itself
+ * would never get past SD.begin(). This stand-in keeps sdcard.ino's own code
+ * as it is and sends every sector over the SPI bus the way the library does
+ * for a whole, aligned sector (see SD.cpp).
+ */
+#ifndef _SD_H_
+#define _SD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define OUTPUT      1
+#define FILE_WRITE  1
+
+// SD.begin() sets up the SPI pins, chip select included
+static inline void pinMode(uint8_t pin, uint8_t mode) {
+  return;
+}
+
+class File {
+ public:
+  File(void) : is_open(0), block(0) {}
+  explicit File(uint8_t open) : is_open(open), block(0) {}
+
+  size_t write(const uint8_t * data, size_t size);
+  void flush(void) {}
+  void close(void) { is_open = 0; }
+
+  operator bool(void) const { return is_open; }
+
+ private:
+  uint8_t is_open;
+  uint32_t block;       // the card block the next sector goes to
+};
+
+class SDClass {
+ public:
+  bool begin(uint8_t cs_pin);
+  bool exists(const char * path) { return false; }
+  bool mkdir(const char * path) { return true; }
+  File open(const char * path, uint8_t mode) { return File(1); }
+};
+
+extern SDClass SD;
+
+#endif // #ifndef _SD_H_
@@ -0,0 +1,386 @@
+/*
+ * file: bench.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Counts the CPU cycles that demo_sgconzm's busiest code takes on the
+ * ATmega2560. The program is built with avr-gcc exactly like the sketch's own
+ * code and runs under simavr, which simulates the microcontroller cycle for
+ * cycle. Every result is one line of JSON on the simavr console:
+ *
+ *   {"name": "update_all_nav", "runs": 8, "cycles_min": 9876, ...}
+ *
+ * cycles_min and cycles_max are the fewest and most cycles that any of the
+ * runs took; us_max is cycles_max at F_CPU. frame_pct is the share of one
+ * scheduler frame (SCHED_FRAME_MS) that cycles_max would use up, and
+ * budget_pct the share of the old sketches' 25 ms main loop (BUDGET_MS),
+ * which is what the numbers were first asked against.
+ *
+ * Timer4 (unused by the sketch) counts every cycle. The cost of reading it is
+ * measured first and taken off every result. The timebase's and Timer4's own
+ * overflow interrupts still land in a run now and then, so cycles_min is the
+ * number to track from one commit to the next.
+ *
+ * gps.c and twi_master.c are compiled into this file so their ISRs can be fed
+ * a whole sentence or transaction: the registers the ISRs read (UDR2, TWSR,
+ * TWDR) and the TWCR they write are plain variables here. Reading a variable
+ * takes as many cycles as reading the register. scheduler.c is compiled into
+ * this file too, so the background jobs can be run without a frame around
+ * them; Timer1 isn't running, so every job step fits.
+ *
+ * write_data() and the job that drains each record to the card are the
+ * sketch's own, from sdcard.ino. There is no card on simavr's SPI bus, so
+ * the Arduino SD library underneath them is replaced with one that sends the
+ * same SPI traffic for every sector (see SD.cpp). The card's busy time is
+ * not included.
+ *
+ * Usage: see the Makefile
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include <avr/sleep.h>
+
+#include "avr_mcu_section.h"
+#include "hal.h"
+#include "kintobor.h"
+#include "odometer.h"
+#include "scheduler.h"
+#include "sdcard.h"
+#include "statevars.h"
+#include "timebase.h"
+
+static volatile uint8_t bench_udr2;
+static volatile uint8_t bench_twsr;
+static volatile uint8_t bench_twdr;
+static volatile uint8_t bench_twcr;
+
+#undef UDR2
+#define UDR2 bench_udr2
+#undef TWSR
+#define TWSR bench_twsr
+#undef TWDR
+#define TWDR bench_twdr
+#undef TWCR
+#define TWCR bench_twcr
+
+#include "gps.c"
+#include "scheduler.c"
+#include "twi_master.c"
+
+AVR_MCU(F_CPU, "atmega2560");
+AVR_MCU_SIMAVR_CONSOLE(&GPIOR0);
+
+#define CYCLES_PER_US       (F_CPU / 1000000UL)
+#define FRAME_CYCLES        (F_CPU / 1000UL * SCHED_FRAME_MS)
+#define BUDGET_MS           25  // the main loop period before the scheduler
+#define BUDGET_CYCLES       (F_CPU / 1000UL * BUDGET_MS)
+#define TWI_READ_LEN        6   // as many bytes as a compass burst
+
+typedef struct {
+  const char * name;
+  void (*setup)(uint8_t run);   // not counted
+  void (*run)(void);            // counted
+  uint8_t runs;
+} bench_t;
+
+statevars_t statevars;
+
+static const char gpgga[] =
+    "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+static const char gprmc[] =
+    "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n";
+
+// The TWI states of one compass read: write the register, then read a burst
+static const uint8_t twi_states[] = {
+  TW_START, TW_MT_SLA_ACK, TW_MT_DATA_ACK, TW_REP_START, TW_MR_SLA_ACK,
+  TW_MR_DATA_ACK, TW_MR_DATA_ACK, TW_MR_DATA_ACK, TW_MR_DATA_ACK,
+  TW_MR_DATA_ACK, TW_MR_DATA_NACK
+};
+
+static const uint8_t twi_register = 1;
+static uint8_t twi_burst[TWI_READ_LEN];
+static twi_txn_t twi_bench_txn = {
+  0x60, &twi_register, 1, twi_burst, TWI_READ_LEN, NULL, Twi_Idle, 0, 0
+};
+
+static char checksum_sentence[GPS_SENTENCE_BUFF_SZ];
+static volatile uint8_t checksum_result;
+static volatile uint16_t timer4_overflows;
+static uint32_t overhead_cycles;
+
+// Defined in odometer.c; called here like any other function
+void ODOMETER_ISR_VECT(void);
+
+static int console_putc(char c, FILE * stream);
+static FILE console = FDEV_SETUP_STREAM(console_putc, NULL, _FDEV_SETUP_WRITE);
+
+ISR(TIMER4_OVF_vect) {
+  timer4_overflows++;
+}
+
+static int console_putc(char c, FILE * stream) {
+  GPIOR0 = c;
+
+  return 0;
+}
+
+// Returns the number of cycles since Timer4 was started
+static uint32_t cycles_now(void) {
+  uint8_t sreg = SREG;
+  cli();
+
+  uint16_t count = TCNT4;
+  uint16_t overflows = timer4_overflows;
+
+  // An overflow that hasn't been counted yet
+  if ((TIFR4 & (1 << TOV4)) && count < 0x8000) {
+    overflows++;
+  }
+
+  SREG = sreg;
+
+  return ((uint32_t) overflows << 16) | count;
+}
+
+static void no_setup(uint8_t run) {
+  return;
+}
+
+static void no_run(void) {
+  return;
+}
+
+static void checksum_setup(uint8_t run) {
+  strcpy(checksum_sentence, gpgga);
+
+  return;
+}
+
+static void checksum_run(void) {
+  checksum_result = validate_checksum(checksum_sentence);
+
+  return;
+}
+
+static void fill_gps_buffer(const char * sentence) {
+  strcpy(gps_buffers[0].sentence, sentence);
+  gps_buffers[0].received_at = timebase_now();
+  gps_buffers[0].ready = 1;
+
+  return;
+}
+
+static void gpgga_setup(uint8_t run) {
+  fill_gps_buffer(gpgga);
+
+  return;
+}
+
+static void gprmc_setup(uint8_t run) {
+  fill_gps_buffer(gprmc);
+
+  return;
+}
+
+// Every run gets a new fix and fresh compass and odometer readings
+static void nav_setup(uint8_t run) {
+  uint32_t now = timebase_now();
+
+  statevars.status = STATUS_GPS_FIX_AVAIL | STATUS_GPS_GPRMC_RCVD;
+  statevars.gps_lat_ddeg += 0.00001;
+  statevars.gps_long_ddeg += 0.00001;
+  sample_stamp(&statevars.gps_meta, now, 1);
+
+  statevars.heading_deg = 90.0 + run;
+  sample_stamp(&statevars.compass_meta, now, 1);
+
+  statevars.odometer_ticks += 8;
+
+  return;
+}
+
+// Feeds the GPGGA sentence to the ISR one character per run
+static void usart_setup(uint8_t run) {
+  if (run == 0) {
+    uint8_t i;
+    for (i = 0; i < NUM_GPS_SENTENCE_BUFFS; i++) {
+      gps_buffers[i].ready = 0;
+    }
+    buffer_index = -1;
+  }
+
+  bench_udr2 = gpgga[run];
+
+  return;
+}
+
+static void usart_run(void) {
+  USART2_RX_vect();
+
+  return;
+}
+
+// Walks the ISR through one compass read, one state per run
+static void twi_setup(uint8_t run) {
+  if (run == 0) {
+    bench_twcr = 0;
+    twi_submit(&twi_bench_txn);
+  }
+
+  bench_twsr = twi_states[run];
+  bench_twdr = run;
+
+  return;
+}
+
+static void twi_run(void) {
+  TWI_vect();
+
+  return;
+}
+
+static void odometer_run(void) {
+  ODOMETER_ISR_VECT();
+
+  return;
+}
+
+// Every run starts with the published record given back
+static void publish_setup(uint8_t run) {
+  statevars_release();
+
+  return;
+}
+
+static void publish_run(void) {
+  statevars_publish();
+
+  return;
+}
+
+// Every run starts with the previous record written out and a new one published
+static void record_setup(uint8_t run) {
+  run_background_jobs();
+  statevars_release();
+  statevars_publish();
+
+  return;
+}
+
+/* Every run has a freshly published record for the drain job, which writes
+ * all of its sectors in one go since there is no frame to run out of
+ */
+static void drain_setup(uint8_t run) {
+  record_setup(run);
+  write_data();
+
+  return;
+}
+
+static void drain_run(void) {
+  run_background_jobs();
+
+  return;
+}
+
+static const bench_t benches[] = {
+  { "validate_checksum",  checksum_setup, checksum_run,     4 },
+  { "gps_update_gpgga",   gpgga_setup,    gps_update,       4 },
+  { "gps_update_gprmc",   gprmc_setup,    gps_update,       4 },
+  { "update_all_nav",     nav_setup,      update_all_nav,   8 },
+  { "usart2_rx_isr",      usart_setup,    usart_run,        sizeof(gpgga) - 1 },
+  { "twi_isr",            twi_setup,      twi_run,          sizeof(twi_states) },
+  { "odometer_isr",       no_setup,       odometer_run,     8 },
+  { "statevars_publish",  publish_setup,  publish_run,      4 },
+  { "write_data",         record_setup,   write_data,       4 },
+  { "sdcard_drain",       drain_setup,    drain_run,        4 }
+};
+
+#define NUM_BENCHES (sizeof(benches) / sizeof(benches[0]))
+
+/* Runs a benchmark and stores the fewest and most cycles that its runs took,
+ * less the cost of measuring.
+ */
+static void measure(const bench_t * bench, uint32_t * min, uint32_t * max) {
+  uint8_t run;
+
+  *min = UINT32_MAX;
+  *max = 0;
+
+  for (run = 0; run < bench->runs; run++) {
+    bench->setup(run);
+
+    uint32_t start = cycles_now();
+    bench->run();
+    uint32_t cycles = cycles_now() - start;
+
+    cycles = (cycles > overhead_cycles) ? cycles - overhead_cycles : 0;
+
+    if (cycles < *min) {
+      *min = cycles;
+    }
+    if (cycles > *max) {
+      *max = cycles;
+    }
+  }
+
+  return;
+}
+
+static void report(const bench_t * bench, uint32_t min, uint32_t max) {
+  uint32_t us_tenths = max * 10 / CYCLES_PER_US;
+  uint32_t pct_hundredths = max * 10000 / FRAME_CYCLES;
+  uint32_t budget_hundredths = max * 10000 / BUDGET_CYCLES;
+
+  printf("{\"name\": \"%s\", \"runs\": %u, \"cycles_min\": %lu, "
+         "\"cycles_max\": %lu, \"us_max\": %lu.%lu, "
+         "\"frame_pct\": %lu.%02lu, \"budget_pct\": %lu.%02lu}\n",
+         bench->name, bench->runs, (unsigned long) min, (unsigned long) max,
+         (unsigned long) (us_tenths / 10), (unsigned long) (us_tenths % 10),
+         (unsigned long) (pct_hundredths / 100),
+         (unsigned long) (pct_hundredths % 100),
+         (unsigned long) (budget_hundredths / 100),
+         (unsigned long) (budget_hundredths % 100));
+
+  return;
+}
+
+int main(void) {
+  stdout = &console;
+
+  memset(&statevars, 0, sizeof(statevars));
+
+  timebase_init();
+  twi_init(TWI_FREQ_FAST);
+  gps_init();
+  odometer_init();
+  sdcard_init();
+
+  // Timer4 counts every cycle
+  TCCR4A = 0;
+  TCCR4B = (1 << CS40);
+  TIMSK4 = (1 << TOIE4);
+  sei();
+
+  // The cost of calling an empty run between two timer reads
+  const bench_t empty = { "empty", no_setup, no_run, 8 };
+  uint32_t min;
+  uint32_t max;
+  overhead_cycles = 0;
+  measure(&empty, &min, &max);
+  overhead_cycles = min;
+
+  uint8_t i;
+  for (i = 0; i < NUM_BENCHES; i++) {
+    measure(&benches[i], &min, &max);
+    report(&benches[i], min, max);
+  }
+
+  // simavr stops when the CPU sleeps with interrupts disabled
+  cli();
+  sleep_enable();
+  sleep_cpu();
+
+  return 0;
+}
@@ -0,0 +1,27 @@
+/*
+ * file: sdcard.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Declares the functions in the sketch's sdcard.ino, which the Arduino
+ * builder declares on its own when it builds the sketch. The Makefile
+ * includes this file ahead of sdcard.ino, so the functions are compiled with
+ * C linkage and bench.c can call them.
+ */
+#ifndef _SDCARD_H_
+#define _SDCARD_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif // #ifdef __cplusplus
+  uint8_t sdcard_init(void);
+  uint8_t init_datafile(void);
+  void write_data(void);
+  void sdcard_finish(void);
+#ifdef __cplusplus
+}
+#endif // #ifdef __cplusplus
+
+#endif // #ifndef _SDCARD_H_
@@ -0,0 +1,274 @@
+#!/usr/bin/env python3
+"""
+file: compass_fit.py
+created: 20261018
+author(s): mr-augustine
+
+Fits a heading correction for the compass from a calibration spin and writes
+it out as the compass_lut.h lookup table used by compass.c.
+
+Record a spin by building the sketch with COMPASS_CALIBRATION_SPIN set to 1
+(and COMPASS_READ_RAW set to 1) and letting the robot drive at least one full
+circle. The fit then works in three steps:
+
+  1. Hard- and soft-iron: fit an ellipse to the raw magnetometer X/Y samples.
+     Its center is the hard-iron offset and its shape is the soft-iron
+     distortion. Mapping the ellipse back onto a circle gives a heading that
+     is free of both.
+  2. The compass's own heading (heading_raw) is compared against the
+     corrected heading. The error is fit with the classic five-term compass
+     deviation curve: A + B sin h + C cos h + D sin 2h + E cos 2h.
+  3. The curve is evaluated at every whole degree and written out in tenths
+     of a degree. The robot interpolates between entries.
+
+The magnetometer axes aren't assumed to line up with the robot; the axis
+order and signs that agree best with the compass's own heading are used.
+
+--zero writes a compass_lut.h with no table in it. compass.c then leaves the
+heading as the compass reports it, and the table takes up no flash.
+
+Usage: compass_fit.py k00001.dat [-o compass_lut.h] [--header statevars.h]
+       compass_fit.py --zero -o compass_lut.h
+"""
+import argparse
+import math
+import sys
+
+import statevars
+
+LUT_ENTRIES = 360
+HEADING_SCALE = 10      # compass headings are in tenths of a degree
+MIN_SAMPLES = 50
+
+
+def solve(matrix, vector):
+    """Solves a small linear system by Gaussian elimination with partial
+    pivoting."""
+    n = len(vector)
+    a = [list(row) + [vector[i]] for i, row in enumerate(matrix)]
+
+    for col in range(n):
+        pivot = max(range(col, n), key=lambda r: abs(a[r][col]))
+        if abs(a[pivot][col]) < 1e-12:
+            raise ValueError('the samples do not determine a unique fit')
+        a[col], a[pivot] = a[pivot], a[col]
+
+        for row in range(col + 1, n):
+            factor = a[row][col] / a[col][col]
+            for k in range(col, n + 1):
+                a[row][k] -= factor * a[col][k]
+
+    x = [0.0] * n
+    for row in reversed(range(n)):
+        total = a[row][n] - sum(a[row][k] * x[k] for k in range(row + 1, n))
+        x[row] = total / a[row][row]
+    return x
+
+
+def least_squares(rows, targets):
+    """Returns the coefficients that minimise |rows * x - targets|."""
+    n = len(rows[0])
+    ata = [[sum(r[i] * r[j] for r in rows) for j in range(n)] for i in range(n)]
+    atb = [sum(r[i] * t for r, t in zip(rows, targets)) for i in range(n)]
+    return solve(ata, atb)
+
+
+def fit_ellipse(points):
+    """Fits a x^2 + b xy + c y^2 + d x + e y = 1 and returns the center and
+    the symmetric matrix that maps the ellipse onto a circle."""
+    # Center and scale the points first to keep the normal equations sane
+    mx = sum(p[0] for p in points) / len(points)
+    my = sum(p[1] for p in points) / len(points)
+    s = max(max(abs(x - mx), abs(y - my)) for x, y in points) or 1.0
+    scaled = [((x - mx) / s, (y - my) / s) for x, y in points]
+
+    rows = [(x * x, x * y, y * y, x, y) for x, y in scaled]
+    a, b, c, d, e = least_squares(rows, [1.0] * len(rows))
+
+    # The center is where the gradient of the conic vanishes
+    det = 4 * a * c - b * b
+    if det <= 0:
+        raise ValueError('the magnetometer samples do not form an ellipse; '
+                         'did the robot drive a full circle?')
+    cx = (b * e - 2 * c * d) / det
+    cy = (b * d - 2 * a * e) / det
+
+    # sqrt of [[a, b/2], [b/2, c]] maps the ellipse onto a circle
+    p, q, r = a, b / 2.0, c
+    root_det = math.sqrt(p * r - q * q)
+    t = math.sqrt(p + r + 2 * root_det)
+    shape = ((p + root_det) / t, q / t, (r + root_det) / t)
+
+    return (mx + cx * s, my + cy * s), shape
+
+
+def wrap180(deg):
+    return (deg + 180.0) % 360.0 - 180.0
+
+
+def corrected_headings(points, center, shape, order):
+    """Applies the hard/soft-iron correction and returns a heading per point
+    for the given axis order/sign choice."""
+    swap, sx, sy = order
+    a, b, c = shape
+    headings = []
+    for x, y in points:
+        dx = x - center[0]
+        dy = y - center[1]
+        u = a * dx + b * dy
+        v = b * dx + c * dy
+        if swap:
+            u, v = v, u
+        headings.append(math.degrees(math.atan2(sy * v, sx * u)) % 360.0)
+    return headings
+
+
+def fit_deviation(compass, reference):
+    """Fits the five-term deviation curve to reference - compass."""
+    rows = []
+    errors = []
+    for h, ref in zip(compass, reference):
+        rad = math.radians(h)
+        rows.append((1.0, math.sin(rad), math.cos(rad),
+                     math.sin(2 * rad), math.cos(2 * rad)))
+        errors.append(wrap180(ref - h))
+    return least_squares(rows, errors)
+
+
+def deviation(coeffs, heading_deg):
+    a, b, c, d, e = coeffs
+    rad = math.radians(heading_deg)
+    return (a + b * math.sin(rad) + c * math.cos(rad) +
+            d * math.sin(2 * rad) + e * math.cos(2 * rad))
+
+
+def residual(compass, reference, coeffs):
+    errors = [wrap180(ref - h - deviation(coeffs, h))
+              for h, ref in zip(compass, reference)]
+    return math.sqrt(sum(err * err for err in errors) / len(errors))
+
+
+def write_lut(path, table, note):
+    """Writes the table, or a header without one if table is None."""
+    lines = [
+        '/*',
+        ' * file: compass_lut.h',
+        ' * created: 20261018',
+        ' * author(s): mr-augustine',
+        ' *',
+        ' * Heading corrections for compass.c, generated by tools/compass_fit.py.',
+        ' * Entry i is the correction (in tenths of a degree) to add to a heading',
+        ' * of i degrees; headings in between are interpolated.',
+        ' *',
+        ' * %s' % note,
+        ' */',
+        '#ifndef _COMPASS_LUT_H_',
+        '#define _COMPASS_LUT_H_',
+        '',
+    ]
+    if table is None:
+        lines += [
+            '#define COMPASS_LUT_CALIBRATED 0',
+            '',
+        ]
+    else:
+        lines += [
+            '#include <stdint.h>',
+            '',
+            '#include "hal.h"',
+            '',
+            '#define COMPASS_LUT_CALIBRATED 1',
+            '#define COMPASS_LUT_ENTRIES %d' % LUT_ENTRIES,
+            '',
+            'static const int16_t compass_lut[COMPASS_LUT_ENTRIES] PROGMEM = {',
+        ]
+        for start in range(0, LUT_ENTRIES, 10):
+            chunk = ', '.join('%4d' % v for v in table[start:start + 10])
+            comma = ',' if start + 10 < LUT_ENTRIES else ' '
+            lines.append('  %s%s  // %d' % (chunk, comma, start))
+        lines += [
+            '};',
+            '',
+        ]
+    lines += [
+        '#endif // #ifndef _COMPASS_LUT_H_',
+        '',
+    ]
+
+    with open(path, 'w') as f:
+        f.write('\n'.join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[1])
+    parser.add_argument('datfile', nargs='?')
+    parser.add_argument('-o', '--output', default='compass_lut.h')
+    parser.add_argument('--header', default=statevars.default_header())
+    parser.add_argument('--zero', action='store_true',
+                        help='write a header with no table, so that no '
+                             'correction is applied')
+    args = parser.parse_args()
+
+    if args.zero:
+        write_lut(args.output, None,
+                  'No calibration has been applied, so there is no table and '
+                  'headings\n * are left as the compass reports them.')
+        return 0
+
+    if args.datfile is None:
+        parser.error('a .dat file is required unless --zero is given')
+
+    layout = statevars.Layout.for_file(args.header, args.datfile)
+    if 'compass_mag' not in layout.offsets:
+        sys.exit('statevars has no compass_mag; build with COMPASS_READ_RAW')
+
+    points = []
+    compass = []
+    for record in layout.records(args.datfile):
+        if record['compass_samples'] == 0:
+            continue
+        points.append(tuple(record['compass_mag'][:2]))
+        compass.append(record['heading_raw'] / float(HEADING_SCALE))
+
+    if len(points) < MIN_SAMPLES:
+        sys.exit('only %d compass samples; need at least %d' %
+                 (len(points), MIN_SAMPLES))
+
+    center, shape = fit_ellipse(points)
+
+    # Pick the axis order and signs that agree best with the compass
+    best = None
+    for swap in (False, True):
+        for sx in (1, -1):
+            for sy in (1, -1):
+                order = (swap, sx, sy)
+                reference = corrected_headings(points, center, shape, order)
+                coeffs = fit_deviation(compass, reference)
+                rms = residual(compass, reference, coeffs)
+                if best is None or rms < best[0]:
+                    best = (rms, order, coeffs)
+
+    rms, order, coeffs = best
+    table = [int(round(deviation(coeffs, deg) * HEADING_SCALE))
+             for deg in range(LUT_ENTRIES)]
+
+    print('samples:          %d' % len(points))
+    print('hard-iron offset: x=%.1f y=%.1f' % center)
+    print('soft-iron matrix: [[%.4f %.4f] [%.4f %.4f]]' %
+          (shape[0], shape[1], shape[1], shape[2]))
+    print('axis order:       swap=%s x_sign=%+d y_sign=%+d' % order)
+    print('deviation:        A=%.2f B=%.2f C=%.2f D=%.2f E=%.2f degrees' %
+          tuple(coeffs))
+    print('max correction:   %.1f degrees' %
+          (max(abs(v) for v in table) / float(HEADING_SCALE)))
+    print('residual (rms):   %.2f degrees' % rms)
+
+    write_lut(args.output, table,
+              'Fit from %s: %d samples, %.2f degrees rms residual.' %
+              (args.datfile.replace('\\', '/').split('/')[-1],
+               len(points), rms))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
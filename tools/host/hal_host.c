@@ -0,0 +1,664 @@
+/*
+ * file: hal_host.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Defines the simulated registers and peripherals declared in hal_host.h.
+ *
+ * Simulated time is kept in CPU cycles. A timer's count is brought up to date
+ * lazily, whenever something looks at it, from the cycles that passed since
+ * it was last updated and its prescaler. hal_host_advance() steps from one
+ * event (a timer overflow or the end of a TWI bus operation) to the next, so
+ * interrupts happen at the right simulated time even if nothing reads the
+ * timers in between.
+ *
+ * The TWI model follows the handshake of the real hardware: the firmware
+ * writes TWCR with TWINT set to start the next bus operation (START, SLA+R/W,
+ * a data byte, or STOP); some bus time later the operation's status appears
+ * in TWSR, TWINT is set, and the TWI interrupt is taken. Since every write to
+ * TWCR can't be seen as it happens, the new value is looked at after the TWI
+ * ISR returns (or, while the TWI is idle, whenever TWCR is next accessed).
+ * The TWI must therefore be used with its interrupt enabled.
+ */
+#include <stddef.h>
+
+#include "hal_host.h"
+
+#define HAL_HOST_DEFINE8(name)    volatile uint8_t name;
+#define HAL_HOST_DEFINE16(name)   volatile uint16_t name;
+#define HAL_HOST_CLEAR(name)      name = 0;
+
+HAL_HOST_REGS8(HAL_HOST_DEFINE8)
+HAL_HOST_REGS16(HAL_HOST_DEFINE16)
+
+// One timer tick at the prescaler of 64 that the sketch uses everywhere
+uint16_t hal_host_poll_cycles = 64;
+
+// Raising this lets idle loops that only watch a timer skip ahead faster
+uint16_t hal_host_max_poll_cycles = 64;
+
+// The ISRs are defined by whichever drivers are linked in
+#define HAL_HOST_WEAK_ISR(vector) void vector(void) __attribute__((weak));
+HAL_HOST_WEAK_ISR(TIMER1_OVF_vect)
+HAL_HOST_WEAK_ISR(TIMER3_OVF_vect)
+HAL_HOST_WEAK_ISR(TWI_vect)
+HAL_HOST_WEAK_ISR(TIMER4_CAPT_vect)
+HAL_HOST_WEAK_ISR(TIMER4_OVF_vect)
+HAL_HOST_WEAK_ISR(TIMER5_CAPT_vect)
+HAL_HOST_WEAK_ISR(TIMER5_OVF_vect)
+HAL_HOST_WEAK_ISR(USART2_RX_vect)
+
+// TWI status codes; see Table 24-3 and 24-4 in the Atmel specs
+#define TWS_START           0x08
+#define TWS_REP_START       0x10
+#define TWS_MT_SLA_ACK      0x18
+#define TWS_MT_SLA_NACK     0x20
+#define TWS_MT_DATA_ACK     0x28
+#define TWS_MT_DATA_NACK    0x30
+#define TWS_MR_SLA_ACK      0x40
+#define TWS_MR_SLA_NACK     0x48
+#define TWS_MR_DATA_ACK     0x50
+#define TWS_MR_DATA_NACK    0x58
+#define TWS_NO_INFO         0xF8
+
+#define SREG_I_MASK         (1 << SREG_I)
+#define NEVER               UINT64_MAX
+
+typedef struct {
+  volatile uint8_t * tccra;
+  volatile uint8_t * tccrb;
+  volatile uint8_t * timsk;
+  volatile uint16_t * ocra;
+  volatile uint16_t * icr;
+  void (*ovf_isr)(void);
+  void (*capt_isr)(void);
+  volatile uint16_t count;    // TCNTn
+  uint64_t synced_at;         // cycle of the last whole tick counted
+  uint8_t flags;              // the real interrupt flags
+  volatile uint8_t tifr;      // TIFRn as the firmware sees it
+  uint8_t tifr_shown;         // what TIFRn held when it was last updated
+} sim_timer_t;
+
+static sim_timer_t timer1 = {
+  &TCCR1A, &TCCR1B, &TIMSK1, &OCR1A, &ICR1, TIMER1_OVF_vect, NULL
+};
+static sim_timer_t timer3 = {
+  &TCCR3A, &TCCR3B, &TIMSK3, &OCR3A, &ICR3, TIMER3_OVF_vect, NULL
+};
+static sim_timer_t timer4 = {
+  &TCCR4A, &TCCR4B, &TIMSK4, &OCR4A, &ICR4, TIMER4_OVF_vect, TIMER4_CAPT_vect
+};
+static sim_timer_t timer5 = {
+  &TCCR5A, &TCCR5B, &TIMSK5, &OCR5A, &ICR5, TIMER5_OVF_vect, TIMER5_CAPT_vect
+};
+
+// In interrupt priority order
+static sim_timer_t * const timers[] = { &timer1, &timer3, &timer4, &timer5 };
+#define NUM_TIMERS (sizeof(timers) / sizeof(timers[0]))
+
+typedef enum {
+  Twi_Model_Idle,       // waiting for the firmware to start an operation
+  Twi_Model_Busy,       // an operation is on the bus until twi_done_at
+  Twi_Model_Waiting     // TWINT is set; the TWI interrupt is pending
+} Twi_Model_State;
+
+static volatile uint8_t twcr;
+static uint8_t twi_state;
+static uint64_t twi_done_at;
+static uint8_t twi_next_status;
+static uint8_t twi_next_data;
+static uint8_t twi_status;
+static uint8_t twi_bus_owned;
+static const hal_host_twi_device_t * twi_device;
+static const hal_host_twi_device_t * twi_devices[HAL_HOST_TWI_MAX_DEVICES];
+static uint8_t twi_device_count;
+
+static uint64_t now;
+
+static hal_host_event_fn event_hook;
+static uint64_t event_at = NEVER;
+static uint8_t in_event_hook;
+
+// Where the timer is being polled from and what the next read there costs;
+// see hal_host_tcnt()
+static const void * poll_site;
+static uint16_t poll_step;
+static uint8_t in_isr;
+
+static sim_timer_t * find_timer(uint8_t timer);
+static uint16_t timer_prescaler(const sim_timer_t * t);
+static uint16_t timer_top(const sim_timer_t * t);
+static void sync_timer(sim_timer_t * t);
+static void sync_flags(sim_timer_t * t);
+static uint64_t timer_next_event(const sim_timer_t * t);
+static uint16_t twi_bit_cycles(void);
+static void twi_begin(uint8_t status, uint8_t data, uint8_t bits);
+static void twi_decode(void);
+static void twi_update(void);
+static uint8_t take_interrupt(void);
+static void service(void);
+static uint64_t next_event(uint64_t limit);
+
+static sim_timer_t * find_timer(uint8_t timer) {
+  switch (timer) {
+    case 1:
+      return &timer1;
+    case 3:
+      return &timer3;
+    case 4:
+      return &timer4;
+    case 5:
+      return &timer5;
+    default:
+      return NULL;
+  }
+}
+
+// Returns the number of CPU cycles per timer tick; 0 if the timer is stopped
+static uint16_t timer_prescaler(const sim_timer_t * t) {
+  switch (*t->tccrb & 0x07) {
+    case 1:
+      return 1;
+    case 2:
+      return 8;
+    case 3:
+      return 64;
+    case 4:
+      return 256;
+    case 5:
+      return 1024;
+    default:
+      // Stopped, or clocked from the Tn pin, which isn't simulated
+      return 0;
+  }
+}
+
+// Returns the count after which the timer overflows back to zero
+static uint16_t timer_top(const sim_timer_t * t) {
+  uint8_t wgm = ((*t->tccrb >> 1) & 0x0C) | (*t->tccra & 0x03);
+
+  switch (wgm) {
+    case 14:
+      return *t->icr;
+    case 15:
+      return *t->ocra;
+    default:
+      return 0xFFFF;
+  }
+}
+
+// Counts the ticks that passed since the timer was last looked at
+static void sync_timer(sim_timer_t * t) {
+  if (t->synced_at == now) {
+    return;
+  }
+
+  uint16_t prescaler = timer_prescaler(t);
+
+  if (prescaler == 0) {
+    t->synced_at = now;
+    return;
+  }
+
+  uint64_t ticks = (now - t->synced_at) / prescaler;
+  if (ticks == 0) {
+    return;
+  }
+  t->synced_at += ticks * prescaler;
+
+  uint32_t period = (uint32_t) timer_top(t) + 1;
+  uint64_t position = t->count + ticks;
+
+  if (t->count < period && position >= period) {
+    t->flags |= (1 << TOV1);
+    position = (position - period) % period;
+  }
+
+  t->count = position;
+
+  return;
+}
+
+// Clears the flags the firmware wrote ones to, then shows the flags in TIFRn
+static void sync_flags(sim_timer_t * t) {
+  if (t->tifr != t->tifr_shown) {
+    t->flags &= ~t->tifr;
+  }
+
+  t->tifr = t->flags;
+  t->tifr_shown = t->flags;
+
+  return;
+}
+
+// Returns the cycle at which the timer overflows next
+static uint64_t timer_next_event(const sim_timer_t * t) {
+  uint16_t prescaler = timer_prescaler(t);
+  uint16_t top = timer_top(t);
+
+  if (prescaler == 0 || t->count > top) {
+    return NEVER;
+  }
+
+  return t->synced_at + ((uint64_t) (top - t->count) + 1) * prescaler;
+}
+
+// SCL = F_CPU / (16 + 2 * TWBR * 4^TWPS); see Section 24.5.2 in the specs
+static uint16_t twi_bit_cycles(void) {
+  uint8_t prescaler = 1 << (2 * (TWSR & 0x03));
+
+  return 16 + 2 * TWBR * prescaler;
+}
+
+// Puts an operation on the bus that takes bits SCL periods
+static void twi_begin(uint8_t status, uint8_t data, uint8_t bits) {
+  twcr &= ~(1 << TWINT);
+  twi_next_status = status;
+  twi_next_data = data;
+  twi_done_at = now + (uint64_t) bits * twi_bit_cycles();
+  twi_state = Twi_Model_Busy;
+
+  return;
+}
+
+// Starts the operation that the firmware asked for in TWCR
+static void twi_decode(void) {
+  uint8_t control = twcr;
+
+  if (!(control & (1 << TWINT))) {
+    return;
+  }
+
+  if (control & (1 << TWSTO)) {
+    if (twi_bus_owned && twi_device != NULL && twi_device->stop != NULL) {
+      twi_device->stop(twi_device->context);
+    }
+
+    twi_bus_owned = 0;
+    twi_device = NULL;
+    twi_status = TWS_NO_INFO;
+    twcr &= ~(1 << TWSTO);
+
+    if (!(control & (1 << TWSTA))) {
+      twcr &= ~(1 << TWINT);
+      return;
+    }
+  }
+
+  if (control & (1 << TWSTA)) {
+    twi_begin(twi_bus_owned ? TWS_REP_START : TWS_START, TWDR, 1);
+    twi_bus_owned = 1;
+    return;
+  }
+
+  switch (twi_status) {
+    case TWS_START:
+    case TWS_REP_START: {
+      uint8_t address = TWDR >> 1;
+      uint8_t is_read = TWDR & 0x01;
+      uint8_t ack = 0;
+      uint8_t i;
+
+      twi_device = NULL;
+      for (i = 0; i < twi_device_count; i++) {
+        if (twi_devices[i]->address == address) {
+          twi_device = twi_devices[i];
+        }
+      }
+
+      if (twi_device != NULL) {
+        ack = (twi_device->start == NULL) ||
+              twi_device->start(twi_device->context, is_read);
+      }
+
+      if (is_read) {
+        twi_begin(ack ? TWS_MR_SLA_ACK : TWS_MR_SLA_NACK, TWDR, 9);
+      } else {
+        twi_begin(ack ? TWS_MT_SLA_ACK : TWS_MT_SLA_NACK, TWDR, 9);
+      }
+      break;
+    }
+
+    case TWS_MT_SLA_ACK:
+    case TWS_MT_DATA_ACK: {
+      uint8_t ack = (twi_device->write == NULL) ||
+                    twi_device->write(twi_device->context, TWDR);
+
+      twi_begin(ack ? TWS_MT_DATA_ACK : TWS_MT_DATA_NACK, TWDR, 9);
+      break;
+    }
+
+    case TWS_MR_SLA_ACK:
+    case TWS_MR_DATA_ACK: {
+      uint8_t data = (twi_device->read == NULL) ?
+                     0xFF : twi_device->read(twi_device->context);
+
+      if (control & (1 << TWEA)) {
+        twi_begin(TWS_MR_DATA_ACK, data, 9);
+      } else {
+        twi_begin(TWS_MR_DATA_NACK, data, 9);
+      }
+      break;
+    }
+
+    default:
+      // Nothing left to do without a START or STOP
+      twcr &= ~(1 << TWINT);
+      break;
+  }
+
+  return;
+}
+
+static void twi_update(void) {
+  if (!(twcr & (1 << TWEN))) {
+    twi_state = Twi_Model_Idle;
+    twi_bus_owned = 0;
+    twi_device = NULL;
+    twi_status = TWS_NO_INFO;
+    return;
+  }
+
+  if (twi_state == Twi_Model_Busy && now >= twi_done_at) {
+    twi_status = twi_next_status;
+    TWSR = twi_status | (TWSR & 0x03);
+    TWDR = twi_next_data;
+    twcr |= (1 << TWINT);
+    twi_state = Twi_Model_Waiting;
+  }
+
+  if (twi_state == Twi_Model_Idle) {
+    twi_decode();
+  }
+
+  return;
+}
+
+/* Runs the highest priority interrupt that is enabled and pending.
+ * Returns 1 if one ran; 0 otherwise
+ */
+static uint8_t take_interrupt(void) {
+  void (*isr)(void) = NULL;
+  uint8_t i;
+
+  for (i = 0; i < NUM_TIMERS && isr == NULL; i++) {
+    sim_timer_t * t = timers[i];
+
+    if ((t->flags & (1 << ICF1)) && (*t->timsk & (1 << ICIE1)) &&
+        t->capt_isr != NULL) {
+      t->flags &= ~(1 << ICF1);
+      isr = t->capt_isr;
+    } else if ((t->flags & (1 << TOV1)) && (*t->timsk & (1 << TOIE1)) &&
+               t->ovf_isr != NULL) {
+      t->flags &= ~(1 << TOV1);
+      isr = t->ovf_isr;
+    }
+
+    if (isr != NULL) {
+      sync_flags(t);
+    }
+
+    // The TWI vector sits between Timer3's and Timer4's
+    if (isr == NULL && t == &timer3 && twi_state == Twi_Model_Waiting &&
+        (twcr & (1 << TWIE)) && TWI_vect != NULL) {
+      isr = TWI_vect;
+    }
+  }
+
+  if (isr == NULL && (UCSR2A & (1 << RXC2)) && (UCSR2B & (1 << RXCIE2)) &&
+      USART2_RX_vect != NULL) {
+    isr = USART2_RX_vect;
+  }
+
+  if (isr == NULL) {
+    return 0;
+  }
+
+  SREG &= ~SREG_I_MASK;
+  in_isr = 1;
+  isr();
+  in_isr = 0;
+  SREG |= SREG_I_MASK;
+
+  // Reading UDR2 in the ISR clears RXC2. The TWI ISR has written TWCR with
+  // the next operation, which the next service() starts.
+  if (isr == USART2_RX_vect) {
+    UCSR2A &= ~(1 << RXC2);
+  } else if (isr == TWI_vect) {
+    twi_state = Twi_Model_Idle;
+  }
+
+  return 1;
+}
+
+// Brings the peripherals up to date and takes any pending interrupts
+static void service(void) {
+  uint8_t i;
+
+  do {
+    for (i = 0; i < NUM_TIMERS; i++) {
+      sync_flags(timers[i]);
+      sync_timer(timers[i]);
+      sync_flags(timers[i]);
+    }
+    twi_update();
+  } while ((SREG & SREG_I_MASK) && take_interrupt());
+
+  return;
+}
+
+// Returns the cycle of the next thing that will happen, or limit if that's
+// sooner
+static uint64_t next_event(uint64_t limit) {
+  uint64_t next = limit;
+  uint8_t i;
+
+  for (i = 0; i < NUM_TIMERS; i++) {
+    uint64_t event = timer_next_event(timers[i]);
+    if (event < next) {
+      next = event;
+    }
+  }
+
+  if (twi_state == Twi_Model_Busy && twi_done_at < next) {
+    next = twi_done_at;
+  }
+
+  if (event_at < next && !in_event_hook) {
+    next = event_at;
+  }
+
+  return next;
+}
+
+// Puts every register and peripheral back in its power-on state
+void hal_host_reset(void) {
+  uint8_t i;
+
+  HAL_HOST_REGS8(HAL_HOST_CLEAR)
+  HAL_HOST_REGS16(HAL_HOST_CLEAR)
+
+  UCSR0A = (1 << UDRE0);
+  UCSR2A = (1 << UDRE2);
+  TWSR = TWS_NO_INFO;
+
+  now = 0;
+  for (i = 0; i < NUM_TIMERS; i++) {
+    timers[i]->count = 0;
+    timers[i]->synced_at = 0;
+    timers[i]->flags = 0;
+    timers[i]->tifr = 0;
+    timers[i]->tifr_shown = 0;
+  }
+
+  twcr = 0;
+  twi_state = Twi_Model_Idle;
+  twi_status = TWS_NO_INFO;
+  twi_bus_owned = 0;
+  twi_device = NULL;
+
+  poll_site = NULL;
+  poll_step = 0;
+
+  return;
+}
+
+// Returns the number of CPU cycles simulated since hal_host_reset()
+uint64_t hal_host_cycles(void) {
+  return now;
+}
+
+// Lets the given number of CPU cycles pass, taking interrupts along the way
+void hal_host_advance(uint64_t cycles) {
+  uint64_t target = now + cycles;
+
+  service();
+
+  while (now < target) {
+    uint64_t next = next_event(target);
+
+    if (next > now) {
+      now = next;
+    }
+    service();
+
+    // The hook may run ISRs that read the timers, which lets time pass (and
+    // brings us back here) while it is still running
+    if (event_hook != NULL && now >= event_at && !in_event_hook) {
+      in_event_hook = 1;
+      event_at = event_hook(now);
+      in_event_hook = 0;
+
+      if (event_at <= now) {
+        event_at = now + 1;
+      }
+    }
+  }
+
+  return;
+}
+
+void hal_host_sei(void) {
+  SREG |= SREG_I_MASK;
+  service();
+
+  return;
+}
+
+void hal_host_set_event_hook(hal_host_event_fn hook) {
+  event_hook = hook;
+  event_at = (hook != NULL) ? now : NEVER;
+
+  return;
+}
+
+// Latches the timer's count into ICRn as if its capture edge just arrived
+void hal_host_capture(uint8_t timer) {
+  sim_timer_t * t = find_timer(timer);
+
+  if (t == NULL) {
+    return;
+  }
+
+  sync_flags(t);
+  sync_timer(t);
+  *t->icr = t->count;
+  t->flags |= (1 << ICF1);
+  sync_flags(t);
+  service();
+
+  return;
+}
+
+// Receives a byte on USART2 as if its stop bit just arrived
+void hal_host_usart2_rx(uint8_t data) {
+  service();
+
+  if (!(UCSR2B & (1 << RXEN2))) {
+    return;
+  }
+
+  // The previous byte was never read
+  if (UCSR2A & (1 << RXC2)) {
+    UCSR2A |= (1 << DOR2);
+  }
+
+  UDR2 = data;
+  UCSR2A |= (1 << RXC2);
+  service();
+
+  return;
+}
+
+/* Connects a simulated slave to the TWI bus. The device must stay valid until
+ * the end of the program.
+ * Returns 1 if the device was attached; 0 if there is no room for it
+ */
+uint8_t hal_host_twi_attach(const hal_host_twi_device_t * device) {
+  if (device == NULL || twi_device_count == HAL_HOST_TWI_MAX_DEVICES) {
+    return 0;
+  }
+
+  twi_devices[twi_device_count++] = device;
+
+  return 1;
+}
+
+// Backs TCNTn; every access lets hal_host_poll_cycles pass first
+volatile uint16_t * hal_host_tcnt(uint8_t timer) {
+  sim_timer_t * t = find_timer(timer);
+
+  // A loop that does nothing but read a timer is waiting for it, so each read
+  // from the same place in the program in a row costs twice the previous
+  // one, up to hal_host_max_poll_cycles. A read from anywhere else, or any
+  // other peripheral access from the program, starts over at
+  // hal_host_poll_cycles; ISRs that run in the middle of the wait don't.
+  if (in_isr) {
+    hal_host_advance(hal_host_poll_cycles);
+    return &t->count;
+  }
+
+  const void * site = __builtin_return_address(0);
+
+  if (site == poll_site && poll_step != 0) {
+    poll_step = (poll_step < hal_host_max_poll_cycles / 2) ?
+        poll_step * 2 : hal_host_max_poll_cycles;
+  } else {
+    poll_step = hal_host_poll_cycles;
+  }
+  poll_site = site;
+
+  // Nothing but time has changed since the previous read, so if nothing is
+  // due before this one, the only thing to bring up to date is the timer
+  if (poll_step > hal_host_poll_cycles && now + poll_step < next_event(NEVER)) {
+    now += poll_step;
+    sync_timer(t);
+    return &t->count;
+  }
+
+  hal_host_advance(poll_step);
+
+  return &t->count;
+}
+
+// Backs TIFRn; see sync_flags()
+volatile uint8_t * hal_host_tifr(uint8_t timer) {
+  sim_timer_t * t = find_timer(timer);
+
+  if (!in_isr) {
+    poll_step = 0;
+  }
+  service();
+
+  return &t->tifr;
+}
+
+// Backs TWCR; the TWI is brought up to date before every access
+volatile uint8_t * hal_host_twcr(void) {
+  if (!in_isr) {
+    poll_step = 0;
+  }
+  service();
+
+  return &twcr;
+}
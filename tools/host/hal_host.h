@@ -0,0 +1,484 @@
+/*
+ * file: hal_host.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Stands in for avr-libc's <avr/io.h>, <avr/interrupt.h>, and <avr/pgmspace.h>
+ * when the sketch is compiled for a Linux machine (KINTOBOR_HOST; see hal.h).
+ *
+ * Every register is an ordinary variable with the same name, so the drivers
+ * compile unmodified. The peripherals the drivers rely on are simulated by
+ * hal_host.c against a simulated CPU clock:
+ *   Timer1, Timer3, Timer4, Timer5   counting, overflow (normal mode, and fast
+ *                                    PWM with TOP = ICRn or OCRnA), and input
+ *                                    capture through hal_host_capture()
+ *   USART2 receiver                  bytes arrive through hal_host_usart2_rx()
+ *   TWI master                       bus operations are answered by the
+ *                                    devices given to hal_host_twi_attach()
+ * Everything else (the ports, the USART0 transmitter, ...) just holds whatever
+ * was last written to it.
+ *
+ * Simulated time only passes when the host program calls hal_host_advance(),
+ * or when the firmware reads a timer count. Each such read costs
+ * hal_host_poll_cycles, so busy-wait loops on the timers finish. Reads from
+ * the same place in the program in a row cost more and more, up to
+ * hal_host_max_poll_cycles, so a host program that raises it gets through
+ * idle loops faster. A host program that models the world outside the CPU
+ * (sensors, motors) can hook into the passing of time with
+ * hal_host_set_event_hook().
+ *
+ * ISR(vector) defines an ordinary function, which hal_host.c calls when the
+ * interrupt is enabled and pending and the I bit in SREG is set. Interrupts
+ * are taken by priority (vector number), exactly one at a time.
+ */
+#ifndef _HAL_HOST_H_
+#define _HAL_HOST_H_
+
+#include <stdint.h>
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Registers
+#define HAL_HOST_REGS8(X) \
+  X(PINA) X(DDRA) X(PORTA) X(PINB) X(DDRB) X(PORTB) X(PINC) X(DDRC) X(PORTC) \
+  X(PIND) X(DDRD) X(PORTD) X(PINE) X(DDRE) X(PORTE) X(PINF) X(DDRF) X(PORTF) \
+  X(PING) X(DDRG) X(PORTG) X(PINH) X(DDRH) X(PORTH) X(PINJ) X(DDRJ) X(PORTJ) \
+  X(PINK) X(DDRK) X(PORTK) X(PINL) X(DDRL) X(PORTL) \
+  X(SREG) X(MCUSR) X(EICRA) X(EICRB) X(EIMSK) X(EIFR) \
+  X(TCCR1A) X(TCCR1B) X(TCCR1C) X(TIMSK1) \
+  X(TCCR3A) X(TCCR3B) X(TCCR3C) X(TIMSK3) \
+  X(TCCR4A) X(TCCR4B) X(TCCR4C) X(TIMSK4) \
+  X(TCCR5A) X(TCCR5B) X(TCCR5C) X(TIMSK5) \
+  X(TWBR) X(TWSR) X(TWAR) X(TWDR) X(TWAMR) \
+  X(UCSR0A) X(UCSR0B) X(UCSR0C) X(UBRR0L) X(UBRR0H) X(UDR0) \
+  X(UCSR2A) X(UCSR2B) X(UCSR2C) X(UBRR2L) X(UBRR2H) X(UDR2)
+
+#define HAL_HOST_REGS16(X) \
+  X(OCR1A) X(OCR1B) X(OCR1C) X(ICR1) \
+  X(OCR3A) X(OCR3B) X(OCR3C) X(ICR3) \
+  X(OCR4A) X(OCR4B) X(OCR4C) X(ICR4) \
+  X(OCR5A) X(OCR5B) X(OCR5C) X(ICR5)
+
+#define HAL_HOST_DECLARE8(name)   extern volatile uint8_t name;
+#define HAL_HOST_DECLARE16(name)  extern volatile uint16_t name;
+
+#ifdef __cplusplus
+extern "C" {
+#endif // #ifdef __cplusplus
+  HAL_HOST_REGS8(HAL_HOST_DECLARE8)
+  HAL_HOST_REGS16(HAL_HOST_DECLARE16)
+#ifdef __cplusplus
+}
+#endif // #ifdef __cplusplus
+
+// Reading these lets simulated time pass; see hal_host_poll_cycles
+#define TCNT1   (*hal_host_tcnt(1))
+#define TCNT3   (*hal_host_tcnt(3))
+#define TCNT4   (*hal_host_tcnt(4))
+#define TCNT5   (*hal_host_tcnt(5))
+#define TWCR    (*hal_host_twcr())
+
+// As on the real part, writing a one to a flag clears it. A write that leaves
+// the register unchanged can't be told apart from a read, though, so a flag
+// is only cleared if it wasn't already set when it was written.
+#define TIFR1   (*hal_host_tifr(1))
+#define TIFR3   (*hal_host_tifr(3))
+#define TIFR4   (*hal_host_tifr(4))
+#define TIFR5   (*hal_host_tifr(5))
+
+////////////////////////////////////////////////////////////////////////////////
+// Bit names
+#define SREG_I    7
+
+#define PA0 0
+#define PA1 1
+#define PA2 2
+#define PA3 3
+#define PA4 4
+#define PA5 5
+#define PA6 6
+#define PA7 7
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PB6 6
+#define PB7 7
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+#define PC4 4
+#define PC5 5
+#define PC6 6
+#define PC7 7
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+#define PE0 0
+#define PE1 1
+#define PE2 2
+#define PE3 3
+#define PE4 4
+#define PE5 5
+#define PE6 6
+#define PE7 7
+#define PF0 0
+#define PF1 1
+#define PF2 2
+#define PF3 3
+#define PF4 4
+#define PF5 5
+#define PF6 6
+#define PF7 7
+#define PG0 0
+#define PG1 1
+#define PG2 2
+#define PG3 3
+#define PG4 4
+#define PG5 5
+#define PG6 6
+#define PG7 7
+#define PH0 0
+#define PH1 1
+#define PH2 2
+#define PH3 3
+#define PH4 4
+#define PH5 5
+#define PH6 6
+#define PH7 7
+#define PJ0 0
+#define PJ1 1
+#define PJ2 2
+#define PJ3 3
+#define PJ4 4
+#define PJ5 5
+#define PJ6 6
+#define PJ7 7
+#define PK0 0
+#define PK1 1
+#define PK2 2
+#define PK3 3
+#define PK4 4
+#define PK5 5
+#define PK6 6
+#define PK7 7
+#define PL0 0
+#define PL1 1
+#define PL2 2
+#define PL3 3
+#define PL4 4
+#define PL5 5
+#define PL6 6
+#define PL7 7
+
+#define COM1A1    7
+#define COM1A0    6
+#define COM1B1    5
+#define COM1B0    4
+#define COM1C1    3
+#define COM1C0    2
+#define WGM11     1
+#define WGM10     0
+#define ICNC1     7
+#define ICES1     6
+#define WGM13     4
+#define WGM12     3
+#define CS12      2
+#define CS11      1
+#define CS10      0
+#define ICIE1     5
+#define OCIE1C    3
+#define OCIE1B    2
+#define OCIE1A    1
+#define TOIE1     0
+#define ICF1      5
+#define OCF1C     3
+#define OCF1B     2
+#define OCF1A     1
+#define TOV1      0
+
+#define COM3A1    7
+#define COM3A0    6
+#define COM3B1    5
+#define COM3B0    4
+#define COM3C1    3
+#define COM3C0    2
+#define WGM31     1
+#define WGM30     0
+#define ICNC3     7
+#define ICES3     6
+#define WGM33     4
+#define WGM32     3
+#define CS32      2
+#define CS31      1
+#define CS30      0
+#define ICIE3     5
+#define OCIE3C    3
+#define OCIE3B    2
+#define OCIE3A    1
+#define TOIE3     0
+#define ICF3      5
+#define OCF3C     3
+#define OCF3B     2
+#define OCF3A     1
+#define TOV3      0
+
+#define COM4A1    7
+#define COM4A0    6
+#define COM4B1    5
+#define COM4B0    4
+#define COM4C1    3
+#define COM4C0    2
+#define WGM41     1
+#define WGM40     0
+#define ICNC4     7
+#define ICES4     6
+#define WGM43     4
+#define WGM42     3
+#define CS42      2
+#define CS41      1
+#define CS40      0
+#define ICIE4     5
+#define OCIE4C    3
+#define OCIE4B    2
+#define OCIE4A    1
+#define TOIE4     0
+#define ICF4      5
+#define OCF4C     3
+#define OCF4B     2
+#define OCF4A     1
+#define TOV4      0
+
+#define COM5A1    7
+#define COM5A0    6
+#define COM5B1    5
+#define COM5B0    4
+#define COM5C1    3
+#define COM5C0    2
+#define WGM51     1
+#define WGM50     0
+#define ICNC5     7
+#define ICES5     6
+#define WGM53     4
+#define WGM52     3
+#define CS52      2
+#define CS51      1
+#define CS50      0
+#define ICIE5     5
+#define OCIE5C    3
+#define OCIE5B    2
+#define OCIE5A    1
+#define TOIE5     0
+#define ICF5      5
+#define OCF5C     3
+#define OCF5B     2
+#define OCF5A     1
+#define TOV5      0
+
+#define RXC0      7
+#define TXC0      6
+#define UDRE0     5
+#define FE0       4
+#define DOR0      3
+#define UPE0      2
+#define U2X0      1
+#define MPCM0     0
+#define RXCIE0    7
+#define TXCIE0    6
+#define UDRIE0    5
+#define RXEN0     4
+#define TXEN0     3
+#define UCSZ02    2
+#define RXB80     1
+#define TXB80     0
+#define UMSEL01   7
+#define UMSEL00   6
+#define UPM01     5
+#define UPM00     4
+#define USBS0     3
+#define UCSZ01    2
+#define UCSZ00    1
+#define UCPOL0    0
+
+#define RXC1      7
+#define TXC1      6
+#define UDRE1     5
+#define FE1       4
+#define DOR1      3
+#define UPE1      2
+#define U2X1      1
+#define MPCM1     0
+#define RXCIE1    7
+#define TXCIE1    6
+#define UDRIE1    5
+#define RXEN1     4
+#define TXEN1     3
+#define UCSZ12    2
+#define RXB81     1
+#define TXB81     0
+#define UMSEL11   7
+#define UMSEL10   6
+#define UPM11     5
+#define UPM10     4
+#define USBS1     3
+#define UCSZ11    2
+#define UCSZ10    1
+#define UCPOL1    0
+
+#define RXC2      7
+#define TXC2      6
+#define UDRE2     5
+#define FE2       4
+#define DOR2      3
+#define UPE2      2
+#define U2X2      1
+#define MPCM2     0
+#define RXCIE2    7
+#define TXCIE2    6
+#define UDRIE2    5
+#define RXEN2     4
+#define TXEN2     3
+#define UCSZ22    2
+#define RXB82     1
+#define TXB82     0
+#define UMSEL21   7
+#define UMSEL20   6
+#define UPM21     5
+#define UPM20     4
+#define USBS2     3
+#define UCSZ21    2
+#define UCSZ20    1
+#define UCPOL2    0
+
+#define RXC3      7
+#define TXC3      6
+#define UDRE3     5
+#define FE3       4
+#define DOR3      3
+#define UPE3      2
+#define U2X3      1
+#define MPCM3     0
+#define RXCIE3    7
+#define TXCIE3    6
+#define UDRIE3    5
+#define RXEN3     4
+#define TXEN3     3
+#define UCSZ32    2
+#define RXB83     1
+#define TXB83     0
+#define UMSEL31   7
+#define UMSEL30   6
+#define UPM31     5
+#define UPM30     4
+#define USBS3     3
+#define UCSZ31    2
+#define UCSZ30    1
+#define UCPOL3    0
+
+#define TWINT     7
+#define TWEA      6
+#define TWSTA     5
+#define TWSTO     4
+#define TWWC      3
+#define TWEN      2
+#define TWIE      0
+#define TWPS1     1
+#define TWPS0     0
+
+#define INT0      0
+#define INT1      1
+#define INT2      2
+#define INT3      3
+#define INT4      4
+#define INT5      5
+#define INT6      6
+#define INT7      7
+#define ISC01     1
+#define ISC00     0
+#define ISC11     3
+#define ISC10     2
+#define ISC21     5
+#define ISC20     4
+#define ISC31     7
+#define ISC30     6
+
+////////////////////////////////////////////////////////////////////////////////
+// Interrupts and program memory
+#define ISR(vector)         void vector(void)
+
+#define TIMER1_OVF_vect     hal_host_timer1_ovf_isr
+#define TIMER3_OVF_vect     hal_host_timer3_ovf_isr
+#define TWI_vect            hal_host_twi_isr
+#define TIMER4_CAPT_vect    hal_host_timer4_capt_isr
+#define TIMER4_OVF_vect     hal_host_timer4_ovf_isr
+#define TIMER5_CAPT_vect    hal_host_timer5_capt_isr
+#define TIMER5_OVF_vect     hal_host_timer5_ovf_isr
+#define USART2_RX_vect      hal_host_usart2_rx_isr
+
+#define cli()               (SREG &= (uint8_t) ~(1 << SREG_I))
+#define sei()               hal_host_sei()
+
+#define PROGMEM
+#define pgm_read_byte(p)    (*(const uint8_t *) (p))
+#define pgm_read_word(p)    (*(const uint16_t *) (p))
+#define pgm_read_dword(p)   (*(const uint32_t *) (p))
+
+////////////////////////////////////////////////////////////////////////////////
+// Simulation
+#define HAL_HOST_TWI_MAX_DEVICES  4
+
+/* A simulated TWI slave. The callbacks run when the master addresses the
+ * device (start returns 1 to ACK), writes a byte to it (write returns 1 to
+ * ACK), reads a byte from it, and releases the bus. Any of them may be NULL.
+ */
+typedef struct {
+  uint8_t address;
+  void * context;
+  uint8_t (*start)(void * context, uint8_t is_read);
+  uint8_t (*write)(void * context, uint8_t data);
+  uint8_t (*read)(void * context);
+  void (*stop)(void * context);
+} hal_host_twi_device_t;
+
+/* Called once simulated time reaches the cycle it returned the last time (or
+ * right away after it is set). It may feed the peripherals (e.g., with
+ * hal_host_usart2_rx()) and returns the cycle at which it wants to be called
+ * next.
+ */
+typedef uint64_t (*hal_host_event_fn)(uint64_t now);
+
+#ifdef __cplusplus
+extern "C" {
+#endif // #ifdef __cplusplus
+  extern uint16_t hal_host_poll_cycles;
+  extern uint16_t hal_host_max_poll_cycles;
+
+  void hal_host_reset(void);
+  uint64_t hal_host_cycles(void);
+  void hal_host_advance(uint64_t cycles);
+  void hal_host_sei(void);
+  void hal_host_set_event_hook(hal_host_event_fn hook);
+
+  void hal_host_capture(uint8_t timer);
+  void hal_host_usart2_rx(uint8_t data);
+  uint8_t hal_host_twi_attach(const hal_host_twi_device_t * device);
+
+  volatile uint16_t * hal_host_tcnt(uint8_t timer);
+  volatile uint8_t * hal_host_twcr(void);
+  volatile uint8_t * hal_host_tifr(uint8_t timer);
+#ifdef __cplusplus
+}
+#endif // #ifdef __cplusplus
+
+#endif // #ifndef _HAL_HOST_H_
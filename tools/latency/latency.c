@@ -0,0 +1,827 @@
+/*
+ * file: latency.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Runs the mission (target.c) under simavr, which simulates the ATmega2560
+ * cycle for cycle, and measures how long interrupts have to wait and how long
+ * they hold the CPU while the program is under heavy load:
+ *   GPS         NMEA sentences back to back, with no idle time between bytes,
+ *               at whatever baud rate the receiver is set up for at the time
+ *   odometer    ticks at --odometer-hz, far faster than the car can drive
+ *   compass     a CMPS10 on the TWI bus; with --twi-errors nothing answers,
+ *               so every transaction ends in an error
+ *
+ * The results are lines of JSON. There is one line per interrupt that ran:
+ *
+ *   {"vector": "TWI", "number": 39, "count": 812, "latency_max_cycles": 95,
+ *    "exec_max_cycles": 210, ...}
+ *
+ * The latency is the time from the interrupt being raised while it is
+ * enabled until its ISR starts; exec is the time from then until the ISR
+ * returns. An interrupt that is raised while it is disabled can't be taken
+ * yet, so that run isn't timed (it is still counted). There is one line per
+ * place in the program that ran with interrupts disabled outside of an ISR
+ * (cli() ... sei()), by the address of the instruction that disabled them;
+ * avr-addr2line turns that into a line of source:
+ *
+ *   {"blocked_pc": "0x1a3c", "count": 450, "max_cycles": 61, ...}
+ *
+ * The last line sums up the GPS bytes, with the baud rate they were sent at
+ * in the end (gps_baud) and since when (gps_baud_since_s). Sending starts as
+ * soon as the receiver is enabled, and gps_init() enables it before it sets
+ * the rate (and target.c may change the rate after that), so the harness
+ * follows every change to UBRR2 and U2X2: the byte on its way keeps the old
+ * rate, and the next one is sent at the new one.
+ *
+ * The receiver holds two bytes, and a third waits in its shift register
+ * until the next start bit, which follows right away once the GPS is sending
+ * back to back. So the receive ISR has to read a byte within two byte times
+ * of its arrival. It needs part of its own run to get to the read, and the
+ * harness doesn't see the read itself, so its longest run is taken off the
+ * two byte times; the rest is the tolerance. Every ISR and every blocked
+ * place that has taken as long as the tolerance is flagged with
+ * "can_lose_byte", and so is the receive ISR itself if it waited that long or
+ * ran for longer than a byte time. A byte the simulation actually lost is
+ * counted in bytes_lost, and the first one names the longest stretch with
+ * interrupts disabled in the two byte times before it. The exit status is 1
+ * if any byte was lost.
+ *
+ * simavr hands a waiting byte to the program one byte time after the previous
+ * one was read rather than right away, so after a long block it can count a
+ * loss a little early; it never misses one.
+ *
+ * There is also one line per way the steering (PE4) and throttle (PE5)
+ * pulses were timed, to show how much their widths wander:
+ *
+ *   {"pwm": "steering", "timed_by": "Timer3", "pulses": 100,
+ *    "width_error_min_us": 0.5, "width_error_max_us": 0.5, "jitter_us": 0.0,
+ *    ...}
+ *
+ * The width error is the time from the pin's rising edge to its falling edge,
+ * less the width that was commanded when the pulse started: Timer3's compare
+ * register while Timer3 drives the pin, or Timer1's while the program raises
+ * and clears it ("Timer1 ISRs"; see PWM_SOFTWARE in target.c). The jitter is
+ * how far apart the smallest and largest errors are.
+ *
+ * The Arduino core isn't part of the target, so its Timer0 (millis()) ISR is
+ * not measured.
+ *
+ * Usage: latency build/target_9600.elf [--seconds S] [--odometer-hz HZ]
+ *                                      [--twi-errors]
+ */
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "avr_ioport.h"
+#include "avr_timer.h"
+#include "avr_twi.h"
+#include "avr_uart.h"
+#include "sim_avr.h"
+#include "sim_elf.h"
+#include "sim_interrupts.h"
+#include "sim_io.h"
+#include "sim_irq.h"
+#include "sim_regbit.h"
+
+#define F_CPU               16000000UL
+#define CYCLES_PER_US       (F_CPU / 1000000.0)
+
+#define NUM_VECTORS         57
+#define USART2_RX_VECTOR    51
+#define MAX_BLOCK_SITES     64
+#define BLOCK_HISTORY       16      // latest stretches, to explain a loss
+#define NOT_BLOCKED         (-2)    // no stretch to blame
+
+// USART2 registers (data space addresses) and bits
+#define UCSR2A_ADDR         0xD0
+#define UCSR2B_ADDR         0xD1
+#define UBRR2L_ADDR         0xD4
+#define UBRR2H_ADDR         0xD5
+#define U2X2_BIT            1
+#define RXEN2_BIT           4
+#define BITS_PER_BYTE       10      // start, 8 data, stop
+#define RECEIVER_BYTES      2       // bytes the receiver can hold
+
+// Timer1 and Timer3 registers (data space addresses) and bits
+#define OCR1AL_ADDR         0x88
+#define OCR1BL_ADDR         0x8A
+#define TCCR3A_ADDR         0x90
+#define OCR3BL_ADDR         0x9A
+#define OCR3CL_ADDR         0x9C
+#define COM3C1_BIT          3
+#define COM3B1_BIT          5
+#define TIMER1_TICK_CYCLES  64      // prescaler of 64
+#define TIMER3_TICK_CYCLES  8       // prescaler of 8
+#define NUM_PWM_OUTPUTS     2
+
+#define COMPASS_ADDR        0x60
+#define COMPASS_REGS        32
+#define COMPASS_HEADING     900     // tenths of a degree
+
+typedef struct {
+  uint32_t count;
+  uint8_t timed;        // pending_at is for the run that comes next
+  avr_cycle_count_t pending_at;
+  avr_cycle_count_t entered_at;
+  uint32_t latency_max;
+  uint32_t exec_max;
+} vector_stats_t;
+
+// A place in the main program that disables interrupts
+typedef struct {
+  uint32_t pc;
+  uint32_t count;
+  uint32_t max_cycles;
+} block_site_t;
+
+// A stretch of time with interrupts disabled
+typedef struct {
+  avr_cycle_count_t start;
+  avr_cycle_count_t end;
+  uint32_t pc;
+  int vector;           // the ISR it was in, -1, or NOT_BLOCKED
+} block_t;
+
+// How a pulse was timed
+typedef enum {
+  Pwm_Timer3,
+  Pwm_Software,
+  NUM_PWM_TIMINGS
+} pwm_timing_t;
+
+typedef struct {
+  uint32_t pulses;
+  int32_t error_min;    // measured less commanded width, in cycles
+  int32_t error_max;
+  avr_cycle_count_t period_min;
+  avr_cycle_count_t period_max;
+} pwm_stats_t;
+
+// A pin that carries the steering or throttle pulses
+typedef struct {
+  const char * name;
+  uint8_t pin;          // in port E
+  uint8_t com_bit;      // its COM3x1 bit in TCCR3A
+  uint16_t timer3_ocr;  // its Timer3 compare register
+  uint16_t timer1_ocr;  // and the Timer1 one that ends a software pulse
+  uint8_t high;
+  uint8_t started;      // a pulse has started since the program did
+  pwm_timing_t timing;  // how the latest pulse is timed
+  avr_cycle_count_t rose_at;
+  avr_cycle_count_t commanded;
+  pwm_stats_t stats[NUM_PWM_TIMINGS];
+} pwm_output_t;
+
+typedef struct {
+  avr_irq_t * irq;
+  uint8_t selected;
+  uint8_t reg;
+  uint8_t regs[COMPASS_REGS];
+} compass_t;
+
+static const char * const vector_names[NUM_VECTORS] = {
+  "RESET", "INT0", "INT1", "INT2", "INT3", "INT4", "INT5", "INT6", "INT7",
+  "PCINT0", "PCINT1", "PCINT2", "WDT", "TIMER2_COMPA", "TIMER2_COMPB",
+  "TIMER2_OVF", "TIMER1_CAPT", "TIMER1_COMPA", "TIMER1_COMPB", "TIMER1_COMPC",
+  "TIMER1_OVF", "TIMER0_COMPA", "TIMER0_COMPB", "TIMER0_OVF", "SPI_STC",
+  "USART0_RX", "USART0_UDRE", "USART0_TX", "ANALOG_COMP", "ADC", "EE_READY",
+  "TIMER3_CAPT", "TIMER3_COMPA", "TIMER3_COMPB", "TIMER3_COMPC", "TIMER3_OVF",
+  "USART1_RX", "USART1_UDRE", "USART1_TX", "TWI", "SPM_READY", "TIMER4_CAPT",
+  "TIMER4_COMPA", "TIMER4_COMPB", "TIMER4_COMPC", "TIMER4_OVF", "TIMER5_CAPT",
+  "TIMER5_COMPA", "TIMER5_COMPB", "TIMER5_COMPC", "TIMER5_OVF", "USART2_RX",
+  "USART2_UDRE", "USART2_TX", "USART3_RX", "USART3_UDRE", "USART3_TX"
+};
+
+static const char * const pwm_timing_names[NUM_PWM_TIMINGS] = {
+  "Timer3", "Timer1 ISRs"
+};
+
+// Sent over and over, back to back
+static const char nmea[] =
+    "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n"
+    "$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39\r\n"
+    "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n"
+    "$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48\r\n";
+
+static avr_t * avr;
+static avr_int_vector_t * vector_table[NUM_VECTORS];
+static vector_stats_t vectors[NUM_VECTORS];
+static int running_vector = -1;
+
+static block_site_t sites[MAX_BLOCK_SITES];
+static uint8_t num_sites;
+static uint8_t block_open;
+static block_t block;
+static block_t history[BLOCK_HISTORY];
+static uint8_t history_next;
+
+static avr_irq_t * gps_rx_irq;
+static avr_cycle_count_t byte_cycles;
+static avr_cycle_count_t baud_since;
+static uint32_t bytes_sent;
+static uint32_t bytes_read;
+static uint32_t bytes_lost;
+static avr_cycle_count_t first_loss_at;
+static block_t first_loss_block;
+
+static avr_irq_t * icp_irq;
+static avr_cycle_count_t odometer_half_period;
+static uint8_t icp_level;
+
+static pwm_output_t pwm_outputs[NUM_PWM_OUTPUTS] = {
+  { "steering", 4, COM3B1_BIT, OCR3BL_ADDR, OCR1AL_ADDR },
+  { "throttle", 5, COM3C1_BIT, OCR3CL_ADDR, OCR1BL_ADDR }
+};
+
+static compass_t compass;
+
+static void pending_hook(avr_irq_t * irq, uint32_t value, void * param) {
+  int number = (intptr_t) param;
+  const avr_int_vector_t * vector = vector_table[number];
+
+  // simavr raises the flag of a disabled interrupt too
+  if (value && vector != NULL && avr_regbit_get(avr, vector->enable)) {
+    vectors[number].pending_at = avr->cycle;
+    vectors[number].timed = 1;
+  }
+
+  return;
+}
+
+static void running_hook(avr_irq_t * irq, uint32_t value, void * param) {
+  int number = (intptr_t) param;
+  vector_stats_t * v = &vectors[number];
+
+  if (value) {
+    if (v->timed) {
+      uint32_t latency = avr->cycle - v->pending_at;
+
+      if (latency > v->latency_max) {
+        v->latency_max = latency;
+      }
+
+      v->timed = 0;
+    }
+
+    v->entered_at = avr->cycle;
+    v->count++;
+    running_vector = number;
+
+    // The ISR reads the byte straight away
+    if (number == USART2_RX_VECTOR) {
+      bytes_read++;
+    }
+  } else {
+    uint32_t exec = avr->cycle - v->entered_at;
+
+    if (exec > v->exec_max) {
+      v->exec_max = exec;
+    }
+
+    running_vector = -1;
+  }
+
+  return;
+}
+
+static void watch_vectors(void) {
+  int number;
+  uint8_t i;
+
+  for (i = 0; i < avr->interrupts.vector_count; i++) {
+    avr_int_vector_t * vector = avr->interrupts.vector[i];
+
+    if (vector != NULL && vector->vector < NUM_VECTORS) {
+      vector_table[vector->vector] = vector;
+    }
+  }
+
+  for (number = 1; number < NUM_VECTORS; number++) {
+    avr_irq_t * irq = avr_get_interrupt_irq(avr, number);
+
+    if (irq == NULL) {
+      continue;
+    }
+
+    avr_irq_register_notify(irq + AVR_INT_IRQ_PENDING, pending_hook,
+                            (void *) (intptr_t) number);
+    avr_irq_register_notify(irq + AVR_INT_IRQ_RUNNING, running_hook,
+                            (void *) (intptr_t) number);
+  }
+
+  return;
+}
+
+static void record_block_site(const block_t * b) {
+  uint32_t cycles = b->end - b->start;
+  uint8_t i;
+
+  for (i = 0; i < num_sites; i++) {
+    if (sites[i].pc == b->pc) {
+      break;
+    }
+  }
+
+  if (i == num_sites) {
+    if (num_sites == MAX_BLOCK_SITES) {
+      return;
+    }
+    sites[num_sites].pc = b->pc;
+    num_sites++;
+  }
+
+  sites[i].count++;
+  if (cycles > sites[i].max_cycles) {
+    sites[i].max_cycles = cycles;
+  }
+
+  return;
+}
+
+/* Follows the I bit after every instruction; pc is the instruction that just
+ * ran. A block that starts in an ISR is that ISR's; any other block is the
+ * main program's, and belongs to the instruction that disabled interrupts.
+ */
+static void watch_interrupt_mask(uint32_t pc) {
+  uint8_t masked = !avr->sreg[S_I];
+
+  if (masked && !block_open) {
+    block_open = 1;
+    block.start = avr->cycle;
+    block.pc = pc;
+    block.vector = running_vector;
+  } else if (!masked && block_open) {
+    block_open = 0;
+    block.end = avr->cycle;
+
+    if (block.vector < 0) {
+      record_block_site(&block);
+    }
+
+    history[history_next] = block;
+    history_next = (history_next + 1) % BLOCK_HISTORY;
+  }
+
+  return;
+}
+
+/* Returns the block that overlapped the most with the cycles from start to
+ * now, counting the one still open; its vector is NOT_BLOCKED if none did.
+ */
+static block_t longest_block_since(avr_cycle_count_t start,
+                                   avr_cycle_count_t now) {
+  block_t longest;
+  avr_cycle_count_t longest_cycles = 0;
+  uint8_t i;
+
+  longest.vector = NOT_BLOCKED;
+
+  for (i = 0; i <= BLOCK_HISTORY; i++) {
+    block_t b;
+
+    if (i < BLOCK_HISTORY) {
+      b = history[i];
+    } else if (block_open) {
+      b = block;
+      b.end = now;
+    } else {
+      break;
+    }
+
+    avr_cycle_count_t from = (b.start > start) ? b.start : start;
+    avr_cycle_count_t to = (b.end < now) ? b.end : now;
+
+    if (to > from && to - from > longest_cycles) {
+      longest = b;
+      longest_cycles = to - from;
+    }
+  }
+
+  return longest;
+}
+
+/* How long the receive ISR can be kept waiting without losing a byte: two
+ * byte times, less its longest run, which covers the time it takes to get to
+ * reading the byte.
+ */
+static avr_cycle_count_t rx_tolerance(void) {
+  avr_cycle_count_t window = RECEIVER_BYTES * byte_cycles;
+  avr_cycle_count_t read = vectors[USART2_RX_VECTOR].exec_max;
+
+  return (read < window) ? window - read : 0;
+}
+
+/* The byte sent last has finished arriving. If the receiver already holds two
+ * unread bytes, this one is lost.
+ */
+static void gps_byte_arrived(avr_cycle_count_t now) {
+  int32_t waiting = (int32_t) (bytes_sent - 1 - bytes_read - bytes_lost);
+
+  if (waiting < RECEIVER_BYTES) {
+    return;
+  }
+
+  bytes_lost++;
+
+  if (bytes_lost == 1) {
+    first_loss_at = now;
+    first_loss_block = longest_block_since(now - RECEIVER_BYTES * byte_cycles,
+                                           now);
+  }
+
+  return;
+}
+
+static avr_cycle_count_t gps_tick(avr_t * sim, avr_cycle_count_t when,
+                                  void * param) {
+  if (bytes_sent > 0) {
+    gps_byte_arrived(when);
+  }
+
+  avr_raise_irq(gps_rx_irq, (uint8_t) nmea[bytes_sent % (sizeof(nmea) - 1)]);
+  bytes_sent++;
+
+  return when + byte_cycles;
+}
+
+// Returns the cycles one byte takes at the receiver's current baud rate
+static avr_cycle_count_t receiver_byte_cycles(void) {
+  uint16_t ubrr = avr->data[UBRR2L_ADDR] |
+                  ((uint16_t) avr->data[UBRR2H_ADDR] << 8);
+  uint8_t divisor = (avr->data[UCSR2A_ADDR] & (1 << U2X2_BIT)) ? 8 : 16;
+
+  return (avr_cycle_count_t) divisor * (ubrr + 1) * BITS_PER_BYTE;
+}
+
+// Sends the bytes after this one at the rate the program has just set up
+static void follow_gps_baud(void) {
+  avr_cycle_count_t cycles = receiver_byte_cycles();
+
+  if (cycles != byte_cycles) {
+    byte_cycles = cycles;
+    baud_since = avr->cycle;
+  }
+
+  return;
+}
+
+// Starts sending once the program has enabled the receiver
+static void start_gps(void) {
+  follow_gps_baud();
+
+  avr_cycle_timer_register(avr, byte_cycles, gps_tick, NULL);
+
+  return;
+}
+
+// Falling edges are the ticks (see odometer_init())
+static avr_cycle_count_t odometer_tick(avr_t * sim, avr_cycle_count_t when,
+                                       void * param) {
+  icp_level = !icp_level;
+  avr_raise_irq(icp_irq, icp_level);
+
+  return when + odometer_half_period;
+}
+
+static uint16_t read_register16(uint16_t low_addr) {
+  return avr->data[low_addr] | ((uint16_t) avr->data[low_addr + 1] << 8);
+}
+
+/* Follows a steering or throttle pin. A rising edge starts a pulse, which
+ * takes the width commanded at that moment; the falling edge ends it.
+ */
+static void pwm_pin_hook(avr_irq_t * irq, uint32_t value, void * param) {
+  pwm_output_t * out = param;
+  avr_cycle_count_t now = avr->cycle;
+
+  if (value && !out->high) {
+    pwm_timing_t timing = (avr->data[TCCR3A_ADDR] & (1 << out->com_bit)) ?
+                          Pwm_Timer3 : Pwm_Software;
+    pwm_stats_t * s = &out->stats[timing];
+
+    // The period is counted only between pulses that are timed the same way
+    if (out->started && out->timing == timing) {
+      avr_cycle_count_t period = now - out->rose_at;
+
+      if (s->period_min == 0 || period < s->period_min) {
+        s->period_min = period;
+      }
+      if (period > s->period_max) {
+        s->period_max = period;
+      }
+    }
+
+    if (timing == Pwm_Timer3) {
+      out->commanded = (avr_cycle_count_t) read_register16(out->timer3_ocr) *
+                       TIMER3_TICK_CYCLES;
+    } else {
+      out->commanded = (avr_cycle_count_t) read_register16(out->timer1_ocr) *
+                       TIMER1_TICK_CYCLES;
+    }
+
+    out->timing = timing;
+    out->rose_at = now;
+    out->started = 1;
+  } else if (!value && out->high && out->started) {
+    pwm_stats_t * s = &out->stats[out->timing];
+    int32_t error = (int32_t) (now - out->rose_at - out->commanded);
+
+    if (s->pulses == 0 || error < s->error_min) {
+      s->error_min = error;
+    }
+    if (s->pulses == 0 || error > s->error_max) {
+      s->error_max = error;
+    }
+
+    s->pulses++;
+  }
+
+  out->high = (value != 0);
+
+  return;
+}
+
+static void watch_pwm_pins(void) {
+  uint8_t i;
+
+  for (i = 0; i < NUM_PWM_OUTPUTS; i++) {
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('E'),
+                                          pwm_outputs[i].pin),
+                            pwm_pin_hook, &pwm_outputs[i]);
+  }
+
+  return;
+}
+
+/* Answers as the compass: a write sets the register to read from, and every
+ * read returns the next register.
+ */
+static void compass_hook(avr_irq_t * irq, uint32_t value, void * param) {
+  avr_twi_msg_irq_t msg;
+  msg.u.v = value;
+
+  if (msg.u.twi.msg & TWI_COND_STOP) {
+    compass.selected = 0;
+  }
+
+  if (msg.u.twi.msg & TWI_COND_START) {
+    compass.selected = ((msg.u.twi.addr >> 1) == COMPASS_ADDR);
+    if (compass.selected) {
+      avr_raise_irq(compass.irq + TWI_IRQ_INPUT,
+                    avr_twi_irq_msg(TWI_COND_ACK, msg.u.twi.addr, 1));
+    }
+  }
+
+  if (!compass.selected) {
+    return;
+  }
+
+  if (msg.u.twi.msg & TWI_COND_WRITE) {
+    compass.reg = msg.u.twi.data % COMPASS_REGS;
+    avr_raise_irq(compass.irq + TWI_IRQ_INPUT,
+                  avr_twi_irq_msg(TWI_COND_ACK, msg.u.twi.addr, 1));
+  }
+
+  if (msg.u.twi.msg & TWI_COND_READ) {
+    avr_raise_irq(compass.irq + TWI_IRQ_INPUT,
+                  avr_twi_irq_msg(TWI_COND_READ, msg.u.twi.addr,
+                                  compass.regs[compass.reg]));
+    compass.reg = (compass.reg + 1) % COMPASS_REGS;
+  }
+
+  return;
+}
+
+static void attach_compass(void) {
+  static const char * names[2] = { "8>compass.in", "32<compass.out" };
+
+  compass.irq = avr_alloc_irq(&avr->irq_pool, 0, 2, names);
+  compass.regs[2] = COMPASS_HEADING >> 8;
+  compass.regs[3] = COMPASS_HEADING & 0xFF;
+
+  avr_irq_register_notify(compass.irq + TWI_IRQ_OUTPUT, compass_hook, NULL);
+  avr_connect_irq(avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_OUTPUT),
+                  compass.irq + TWI_IRQ_OUTPUT);
+  avr_connect_irq(compass.irq + TWI_IRQ_INPUT,
+                  avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_INPUT));
+
+  return;
+}
+
+static const char * bool_text(int value) {
+  return value ? "true" : "false";
+}
+
+static void describe_block(const block_t * b, char * text, size_t size) {
+  if (b->vector == NOT_BLOCKED) {
+    snprintf(text, size, "null");
+  } else if (b->vector >= 0) {
+    snprintf(text, size, "\"%s\"", vector_names[b->vector]);
+  } else {
+    snprintf(text, size, "\"pc 0x%04x\"", (unsigned) b->pc);
+  }
+
+  return;
+}
+
+static int compare_sites(const void * a, const void * b) {
+  const block_site_t * x = a;
+  const block_site_t * y = b;
+
+  return (x->max_cycles < y->max_cycles) - (x->max_cycles > y->max_cycles);
+}
+
+static void report(double seconds) {
+  avr_cycle_count_t tolerance = rx_tolerance();
+  int number;
+  uint8_t i;
+
+  for (number = 1; number < NUM_VECTORS; number++) {
+    const vector_stats_t * v = &vectors[number];
+
+    if (v->count == 0) {
+      continue;
+    }
+
+    uint8_t can_lose_byte = (v->exec_max >= tolerance);
+    if (number == USART2_RX_VECTOR) {
+      can_lose_byte = (v->exec_max >= byte_cycles ||
+                       v->latency_max >= tolerance);
+    }
+
+    printf("{\"vector\": \"%s\", \"number\": %d, \"count\": %lu, "
+           "\"latency_max_cycles\": %lu, \"latency_max_us\": %.1f, "
+           "\"exec_max_cycles\": %lu, \"exec_max_us\": %.1f, "
+           "\"can_lose_byte\": %s}\n",
+           vector_names[number], number, (unsigned long) v->count,
+           (unsigned long) v->latency_max, v->latency_max / CYCLES_PER_US,
+           (unsigned long) v->exec_max, v->exec_max / CYCLES_PER_US,
+           bool_text(can_lose_byte));
+  }
+
+  qsort(sites, num_sites, sizeof(sites[0]), compare_sites);
+
+  for (i = 0; i < num_sites; i++) {
+    printf("{\"blocked_pc\": \"0x%04x\", \"count\": %lu, "
+           "\"max_cycles\": %lu, \"max_us\": %.1f, \"can_lose_byte\": %s}\n",
+           (unsigned) sites[i].pc, (unsigned long) sites[i].count,
+           (unsigned long) sites[i].max_cycles,
+           sites[i].max_cycles / CYCLES_PER_US,
+           bool_text(sites[i].max_cycles >= tolerance));
+  }
+
+  for (i = 0; i < NUM_PWM_OUTPUTS; i++) {
+    const pwm_output_t * out = &pwm_outputs[i];
+    int timing;
+
+    for (timing = 0; timing < NUM_PWM_TIMINGS; timing++) {
+      const pwm_stats_t * s = &out->stats[timing];
+
+      if (s->pulses == 0) {
+        continue;
+      }
+
+      printf("{\"pwm\": \"%s\", \"timed_by\": \"%s\", \"pulses\": %lu, "
+             "\"width_error_min_us\": %.1f, \"width_error_max_us\": %.1f, "
+             "\"jitter_us\": %.1f, \"period_min_us\": %.1f, "
+             "\"period_max_us\": %.1f}\n",
+             out->name, pwm_timing_names[timing], (unsigned long) s->pulses,
+             s->error_min / CYCLES_PER_US, s->error_max / CYCLES_PER_US,
+             (s->error_max - s->error_min) / CYCLES_PER_US,
+             s->period_min / CYCLES_PER_US, s->period_max / CYCLES_PER_US);
+    }
+  }
+
+  char blocked_by[32] = "null";
+  char first_loss_s[32] = "null";
+  if (bytes_lost > 0) {
+    describe_block(&first_loss_block, blocked_by, sizeof(blocked_by));
+    snprintf(first_loss_s, sizeof(first_loss_s), "%.6f",
+             (double) first_loss_at / F_CPU);
+  }
+
+  printf("{\"gps_baud\": %.0f, \"gps_baud_since_s\": %.6f, "
+         "\"byte_us\": %.1f, \"tolerance_us\": %.1f, "
+         "\"bytes_sent\": %lu, \"bytes_lost\": %lu, \"first_loss_s\": %s, "
+         "\"first_loss_blocked_by\": %s, \"sim_s\": %.3f}\n",
+         (double) F_CPU * BITS_PER_BYTE / byte_cycles,
+         (double) baud_since / F_CPU,
+         byte_cycles / CYCLES_PER_US, tolerance / CYCLES_PER_US,
+         (unsigned long) bytes_sent, (unsigned long) bytes_lost,
+         first_loss_s, blocked_by, seconds);
+
+  return;
+}
+
+static void usage(const char * name) {
+  fprintf(stderr, "usage: %s firmware.elf [--seconds S] [--odometer-hz HZ]"
+          " [--twi-errors]\n", name);
+
+  exit(2);
+}
+
+int main(int argc, char ** argv) {
+  static const struct option options[] = {
+    { "seconds",      required_argument, NULL, 's' },
+    { "odometer-hz",  required_argument, NULL, 'o' },
+    { "twi-errors",   no_argument,       NULL, 't' },
+    { NULL, 0, NULL, 0 }
+  };
+  double seconds = 2.0;
+  double odometer_hz = 1000.0;
+  int twi_errors = 0;
+  int opt;
+
+  while ((opt = getopt_long(argc, argv, "", options, NULL)) != -1) {
+    switch (opt) {
+      case 's':
+        seconds = atof(optarg);
+        break;
+      case 'o':
+        odometer_hz = atof(optarg);
+        break;
+      case 't':
+        twi_errors = 1;
+        break;
+      default:
+        usage(argv[0]);
+    }
+  }
+
+  if (optind != argc - 1 || seconds <= 0.0 || odometer_hz < 0.0) {
+    usage(argv[0]);
+  }
+
+  elf_firmware_t firmware;
+  memset(&firmware, 0, sizeof(firmware));
+  if (elf_read_firmware(argv[optind], &firmware) != 0) {
+    fprintf(stderr, "can't read %s\n", argv[optind]);
+    return 2;
+  }
+
+  avr = avr_make_mcu_by_name("atmega2560");
+  if (avr == NULL) {
+    fprintf(stderr, "this simavr doesn't know the atmega2560\n");
+    return 2;
+  }
+  avr_init(avr);
+  avr_load_firmware(avr, &firmware);
+  avr->frequency = F_CPU;
+
+  // Keep the debug output on USART0 out of the results
+  uint32_t flags = 0;
+  avr_ioctl(avr, AVR_IOCTL_UART_GET_FLAGS('0'), &flags);
+  flags &= ~AVR_UART_FLAG_STDIO;
+  avr_ioctl(avr, AVR_IOCTL_UART_SET_FLAGS('0'), &flags);
+
+  gps_rx_irq = avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('2'), UART_IRQ_INPUT);
+  icp_irq = avr_io_getirq(avr, AVR_IOCTL_TIMER_GETIRQ('5'), TIMER_IRQ_IN_ICP);
+  icp_level = 1;
+
+  watch_vectors();
+  watch_pwm_pins();
+
+  if (!twi_errors) {
+    attach_compass();
+  }
+
+  if (odometer_hz > 0.0) {
+    odometer_half_period = (avr_cycle_count_t) (F_CPU / odometer_hz / 2);
+    avr_cycle_timer_register(avr, odometer_half_period, odometer_tick, NULL);
+  }
+
+  avr_cycle_count_t end = (avr_cycle_count_t) (seconds * F_CPU);
+  uint8_t gps_started = 0;
+  int state = cpu_Running;
+
+  while (avr->cycle < end && state != cpu_Done && state != cpu_Crashed) {
+    uint32_t pc = avr->pc;
+    state = avr_run(avr);
+    watch_interrupt_mask(pc);
+
+    if (gps_started) {
+      follow_gps_baud();
+    } else if (avr->data[UCSR2B_ADDR] & (1 << RXEN2_BIT)) {
+      start_gps();
+      gps_started = 1;
+    }
+  }
+
+  if (state == cpu_Crashed) {
+    fprintf(stderr, "the program crashed at pc 0x%04x\n", (unsigned) avr->pc);
+    return 2;
+  }
+
+  if (!gps_started) {
+    fprintf(stderr, "the program never enabled the GPS receiver\n");
+    return 2;
+  }
+
+  report((double) avr->cycle / F_CPU);
+
+  return (bytes_lost > 0) ? 1 : 0;
+}
@@ -0,0 +1,129 @@
+/*
+ * file: target.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * The program that latency.c runs under simavr: demo_sgconzm's mission (see
+ * mission.h), built for the ATmega2560 from the sketch's own drivers,
+ * scheduler, navigation, and control code. The Arduino core, the SD card, and
+ * the wait for the button are left out, so the mission starts as soon as
+ * everything is initialized and never ends.
+ *
+ * GPS_BAUD sets the GPS receiver's baud rate. gps_init() sets up 9600 baud;
+ * any other rate is set up once everything is initialized.
+ *
+ * PWM_SOFTWARE set to 1 times the steering and throttle pulses the way the
+ * sketch did before Timer3 generated them, so latency.c can compare the two:
+ * the main loop raises both pins at the start of every frame, and the Timer1
+ * compare ISRs clear them. Timer3 still counts the PWM frames and its compare
+ * registers still hold the pulse widths the mission asks for, but it no
+ * longer drives the pins.
+ */
+#include <stdint.h>
+#include <string.h>
+
+#include "hal.h"
+#include "kintobor.h"
+#include "pins.h"
+
+#ifndef GPS_BAUD
+#define GPS_BAUD 9600UL
+#endif
+
+#ifndef PWM_SOFTWARE
+#define PWM_SOFTWARE 0
+#endif
+
+// Timer3 ticks (0.5 us) in one Timer1 tick (4 us)
+#define PWM_TICKS_PER_SCHED_TICK  (PWM_TICKS_PER_US * 1000 / SCHED_TICKS_PER_MS)
+
+statevars_t statevars;
+
+// There is no SD card to write to
+void mission_log_task(void) {
+  statevars.status = 0;
+
+  return;
+}
+
+/* Switches the GPS receiver to GPS_BAUD in double speed mode, which comes
+ * closest to the high rates at 16 MHz.
+ */
+static void set_gps_baud(void) {
+  if (GPS_BAUD == 9600UL) {
+    return;
+  }
+
+  uint16_t ubrr = (F_CPU / 8 + GPS_BAUD / 2) / GPS_BAUD - 1;
+
+  UCSR2A |= (1 << U2X2);
+  UBRR2H = ubrr >> 8;
+  UBRR2L = ubrr & 0xFF;
+
+  return;
+}
+
+#if PWM_SOFTWARE
+ISR(TIMER1_COMPA_vect) {
+  STEERING_PORT &= ~(1 << STEERING_PIN);
+}
+
+ISR(TIMER1_COMPB_vect) {
+  THROTTLE_PORT &= ~(1 << THROTTLE_PIN);
+}
+
+// Takes the pins away from Timer3 and has the Timer1 compare ISRs end pulses
+static void start_software_pwm(void) {
+  TCCR3A &= ~((1 << COM3B1) | (1 << COM3C1));
+  TIMSK1 |= (1 << OCIE1A) | (1 << OCIE1B);
+
+  return;
+}
+
+/* Starts this frame's pulses, just before sched_run_frame() restarts Timer1.
+ * The widths are the ones the mission left in Timer3's compare registers.
+ */
+static void start_software_pulses(void) {
+  OCR1A = STEERING_COMPARE_REG / PWM_TICKS_PER_SCHED_TICK;
+  OCR1B = THROTTLE_COMPARE_REG / PWM_TICKS_PER_SCHED_TICK;
+
+  THROTTLE_PORT |= (1 << THROTTLE_PIN);
+  STEERING_PORT |= (1 << STEERING_PIN);
+
+  return;
+}
+#endif // #if PWM_SOFTWARE
+
+int main(void) {
+  if (!init_all_subsystems()) {
+    return 1;
+  }
+
+  set_gps_baud();
+
+  memset(&statevars, 0, sizeof(statevars));
+  statevars.prefix = 0xDADAFEED;
+  statevars.suffix = 0xCAFEBABE;
+
+  if (!mission_init()) {
+    return 1;
+  }
+
+  update_all_inputs();
+  update_nav_control_values();
+
+  sched_start();
+
+#if PWM_SOFTWARE
+  start_software_pwm();
+#endif
+
+  for (;;) {
+#if PWM_SOFTWARE
+    start_software_pulses();
+#endif
+    sched_run_frame();
+  }
+
+  return 0;
+}
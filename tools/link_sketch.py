@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""
+file: link_sketch.py
+created: 20261018
+author(s): mr-augustine
+
+Links a sketch to the kintobor core. The features a sketch is built with are
+switched on in its kintobor_config.h (see kintobor/kintobor_features.h). The
+sketch's folder gets a relative symbolic link to each core file that those
+features need, and to no others, since the Arduino IDE compiles every .c and
+.ino file in a sketch's folder.
+
+Links to core files that the sketch no longer needs are removed. With --copy
+the files are copied instead of linked, for file systems without symbolic
+links. Copies have to be refreshed by running the tool again whenever the
+core changes. With --check nothing is changed; the tool lists what is missing
+or out of date and exits with 1 if anything is.
+
+Usage: link_sketch.py SKETCH_DIR... [--copy] [--check]
+"""
+import argparse
+import filecmp
+import os
+import shutil
+import sys
+
+import statevars
+
+CORE_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..',
+                        'kintobor')
+
+# (feature switch, the core files it needs); None is every sketch
+FEATURE_FILES = [
+    (None, ['boot.c', 'boot.h', 'hal.h', 'kintobor.c', 'kintobor.h',
+            'kintobor_features.h', 'pins.h', 'ram.c', 'ram.h', 'sample.h',
+            'scheduler.c', 'scheduler.h', 'statevars.h', 'timebase.c',
+            'timebase.h', 'uwrite.c', 'uwrite.h']),
+    ('KINTOBOR_WITH_BUTTON', ['ledbutton.c', 'ledbutton.h']),
+    ('KINTOBOR_WITH_GPS', ['gps.c', 'gps.h', 'snapshot.h']),
+    ('KINTOBOR_WITH_COMPASS', ['compass.c', 'compass.h', 'compass_lut.h',
+                               'twi.h', 'twi_master.c', 'twi_master.h']),
+    ('KINTOBOR_WITH_ODOMETER', ['odometer.c', 'odometer.h', 'snapshot.h']),
+    ('KINTOBOR_WITH_MOBILITY', ['cruise.c', 'cruise.h', 'mobility.c',
+                                'mobility.h', 'motion_profile.c',
+                                'motion_profile.h']),
+    ('KINTOBOR_WITH_PUBLISH', ['publish.c', 'publish.h', 'snapshot.h']),
+    ('KINTOBOR_WITH_SDCARD', ['sdcard.ino']),
+    ('KINTOBOR_WITH_MISSION', ['mission.c', 'mission.h']),
+]
+
+
+def core_files(sketch_dir):
+    """Returns the names of the core files that a sketch's features need."""
+    config = os.path.join(sketch_dir, 'kintobor_config.h')
+    if not os.path.exists(config):
+        raise ValueError('%s has no kintobor_config.h' % sketch_dir)
+
+    # The config is read through kintobor_features.h, which fills in the
+    # switches that depend on others
+    defines = statevars.read_defines(
+        os.path.join(CORE_DIR, 'kintobor_features.h'),
+        statevars.read_defines(config))
+    names = set()
+    for feature, files in FEATURE_FILES:
+        if feature is None or defines.get(feature, 0):
+            names.update(files)
+    return sorted(names)
+
+
+def is_core_link(path):
+    return (os.path.islink(path) and
+            os.path.realpath(path).startswith(
+                os.path.realpath(CORE_DIR) + os.sep))
+
+
+def link_sketch(sketch_dir, copy, check):
+    """Brings a sketch's links (or copies) up to date and returns the list of
+    changes; with check, returns what would change."""
+    wanted = core_files(sketch_dir)
+    changes = []
+
+    for name in sorted(os.listdir(sketch_dir)):
+        path = os.path.join(sketch_dir, name)
+        if name not in wanted and is_core_link(path):
+            changes.append('remove %s' % path)
+            if not check:
+                os.remove(path)
+
+    for name in wanted:
+        path = os.path.join(sketch_dir, name)
+        source = os.path.join(CORE_DIR, name)
+        target = os.path.relpath(source, sketch_dir)
+
+        if copy:
+            if (os.path.isfile(path) and not os.path.islink(path) and
+                    filecmp.cmp(path, source, shallow=False)):
+                continue
+        elif os.path.islink(path) and os.readlink(path) == target:
+            continue
+        elif os.path.exists(path) and not os.path.islink(path):
+            raise ValueError('%s is not a link to the core' % path)
+
+        changes.append('%s %s' % ('copy' if copy else 'link', path))
+        if check:
+            continue
+
+        if os.path.lexists(path):
+            os.remove(path)
+        if copy:
+            shutil.copyfile(source, path)
+        else:
+            os.symlink(target, path)
+
+    return changes
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[1])
+    parser.add_argument('sketches', nargs='+', metavar='SKETCH_DIR')
+    parser.add_argument('--copy', action='store_true',
+                        help='copy the core files instead of linking them')
+    parser.add_argument('--check', action='store_true',
+                        help='only report what is missing or out of date')
+    args = parser.parse_args()
+
+    stale = False
+    for sketch_dir in args.sketches:
+        try:
+            changes = link_sketch(sketch_dir, args.copy, args.check)
+        except ValueError as e:
+            sys.exit(str(e))
+
+        for change in changes:
+            print(change)
+        stale = stale or bool(changes)
+
+    return 1 if args.check and stale else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+"""
+file: loop_report.py
+created: 20261018
+author(s): mr-augustine
+
+Summarises the per-task timing that the scheduler records in statevars.
+For each task in the mission task table this prints the number of samples,
+the min/mean/percentile/max run time in microseconds, the number of missed
+deadlines, and a histogram of run times. It also reports the slack left at
+the end of each frame, i.e. the headroom that remains for background jobs,
+how long the job steps took compared with the budgets they declared, and the
+stack high-water mark if the firmware measured it (see ram_report.py).
+
+If the sensors stamp their values (the *_meta fields in statevars), it also
+reports each sensor's latency: how old a new measurement was when
+navigation first used it.
+
+A task only contributes a sample to a record when its run counter advanced
+since the previous record; otherwise the same run time would be counted
+once per record.
+
+Usage: loop_report.py k00001.dat [--header statevars.h] [--tasks a,b,c]
+"""
+import argparse
+import sys
+
+import statevars
+
+MICROS_PER_TICK = 4
+
+# The task names of the mission task table (kintobor/mission.c), in table
+# order
+SGCONZM_TASKS = [
+    'log', 'button', 'gps', 'compass', 'odometer', 'nav', 'control',
+    'control_output',
+]
+
+
+def percentile(sorted_values, pct):
+    if not sorted_values:
+        return 0
+    index = int(round((len(sorted_values) - 1) * pct / 100.0))
+    return sorted_values[index]
+
+
+def histogram(values, bins, width=50):
+    lo = min(values)
+    hi = max(values)
+    step = max(1, (hi - lo + bins) // bins)
+
+    counts = [0] * bins
+    for v in values:
+        counts[min(bins - 1, (v - lo) // step)] += 1
+
+    peak = max(counts)
+    lines = []
+    for i, count in enumerate(counts):
+        start = lo + i * step
+        bar = '#' * (count * width // peak) if peak else ''
+        lines.append('    %6d-%-6d us %7d %s' % (start, start + step - 1,
+                                                  count, bar))
+    return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[1])
+    parser.add_argument('datafile')
+    parser.add_argument('--header', default=statevars.default_header(),
+                        help='statevars.h of the sketch that wrote the file')
+    parser.add_argument('--tasks', default=','.join(SGCONZM_TASKS),
+                        help='comma-separated task names in table order')
+    parser.add_argument('--bins', type=int, default=10)
+    args = parser.parse_args()
+
+    layout = statevars.Layout.for_file(args.header, args.datafile)
+    names = args.tasks.split(',')
+    num_tasks = layout.defines['SCHED_MAX_TASKS']
+
+    samples = [[] for _ in range(num_tasks)]
+    busy = []
+    slack = []
+    prev_runs = [0] * num_tasks
+    last = None
+
+    sensors = sorted(name[:-len('.timestamp')] for name in layout.offsets
+                     if name.endswith('_meta.timestamp'))
+    if 'nav_timestamp' not in layout.offsets:
+        sensors = []
+    latencies = dict((sensor, []) for sensor in sensors)
+    prev_seqs = dict((sensor, 0) for sensor in sensors)
+
+    for record in layout.records(args.datafile):
+        runs = record['sched_task_runs']
+        for i in range(num_tasks):
+            if runs[i] != prev_runs[i]:
+                samples[i].append(record['sched_task_ticks'][i] *
+                                  MICROS_PER_TICK)
+        prev_runs = runs
+        busy.append(record['sched_frame_busy_ticks'] * MICROS_PER_TICK)
+        slack.append(record['sched_slack_ticks'] * MICROS_PER_TICK)
+
+        for sensor in sensors:
+            seq = record[sensor + '.seq']
+            if seq != prev_seqs[sensor] and record[sensor + '.valid']:
+                age = (record['nav_timestamp'] -
+                       record[sensor + '.timestamp']) & 0xffffffff
+                latencies[sensor].append(age * MICROS_PER_TICK)
+            prev_seqs[sensor] = seq
+
+        last = record
+
+    if last is None:
+        sys.exit('no statevars records found in %s' % args.datafile)
+
+    print('%d records, frame busy time: mean %d us, max %d us' %
+          (len(busy), sum(busy) // len(busy), max(busy)))
+    print('frame slack: mean %d us, min %d us (firmware min %d us)' %
+          (sum(slack) // len(slack), min(slack),
+           last['sched_min_slack_ticks'] * MICROS_PER_TICK))
+    print('background jobs: %d done, %d dropped' %
+          (last['sched_jobs_done'], last['sched_jobs_dropped']))
+    if 'sched_job_max_ticks' in layout.offsets:
+        print('  longest step %d us, at most %d us over its budget, '
+              '%d steps past the end of the frame' %
+              (last['sched_job_max_ticks'] * MICROS_PER_TICK,
+               last['sched_job_max_over_ticks'] * MICROS_PER_TICK,
+               last['sched_job_overruns']))
+    if last.get('publish_skipped'):
+        print('records skipped while the previous one was being written: %d' %
+              last['publish_skipped'])
+    if last.get('ram_stack_peak'):
+        print('RAM: stack peak %d bytes, heap-to-stack gap min %d bytes' %
+              (last['ram_stack_peak'], last['ram_free_min']))
+
+    for i in range(num_tasks):
+        if not samples[i]:
+            continue
+
+        name = names[i] if i < len(names) else 'task%d' % i
+        values = sorted(samples[i])
+
+        print('')
+        print('%s: %d samples, %d overruns' %
+              (name, len(values), last['sched_overruns'][i]))
+        print('  min %d  mean %d  p50 %d  p99 %d  max %d us' %
+              (values[0], sum(values) // len(values),
+               percentile(values, 50), percentile(values, 99), values[-1]))
+        print('  firmware running mean %d us, max %d us' %
+              (last['sched_task_mean_ticks'][i] * MICROS_PER_TICK,
+               last['sched_task_max_ticks'][i] * MICROS_PER_TICK))
+        for line in histogram(values, args.bins):
+            print(line)
+
+    for sensor in sensors:
+        values = sorted(latencies[sensor])
+        if not values:
+            continue
+
+        print('')
+        print('%s latency: %d samples' % (sensor[:-len('_meta')],
+                                          len(values)))
+        print('  min %d  mean %d  p50 %d  p99 %d  max %d us' %
+              (values[0], sum(values) // len(values),
+               percentile(values, 50), percentile(values, 99), values[-1]))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""
+file: ram_report.py
+created: 20261018
+author(s): mr-augustine
+
+Prints the RAM budget of a build for the ATmega2560. The static data (.data,
+.bss, and .noinit) is read from the build's ELF file with avr-size, and the
+largest variables with avr-nm. Whatever the static data leaves of the 8 KB of
+SRAM is shared by the heap and the stack.
+
+With --log, the stack high-water mark that the build recorded in its
+statevars (ram_stack_peak and ram_free_min; see kintobor/ram.h) is added to
+the report, so the measured headroom can be compared with the budget.
+
+With --min-free, the tool exits with 1 if less than that many bytes are left
+for the heap and the stack (or, with --log, if the smallest measured gap
+between them was below it), so a build that grows too large can fail a check.
+
+The Arduino IDE keeps the ELF file in its build folder; arduino-cli puts it
+next to the sketch with --export-binaries. AVR_SIZE and AVR_NM name the tools
+if they aren't on the path as avr-size and avr-nm.
+
+Usage: ram_report.py sketch.elf [--log k00001.dat [--header statevars.h]]
+                     [--top N] [--min-free BYTES]
+"""
+import argparse
+import os
+import subprocess
+import sys
+
+import statevars
+
+RAM_SIZE = 8192
+STATIC_SECTIONS = ('.data', '.bss', '.noinit')
+RAM_SYMBOL_TYPES = 'bBdD'
+
+
+def section_sizes(elf):
+    """Returns the size of each section of the ELF file."""
+    output = subprocess.check_output(
+        [os.environ.get('AVR_SIZE', 'avr-size'), '-A', elf],
+        universal_newlines=True)
+
+    sizes = {}
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) >= 2 and fields[0].startswith('.'):
+            sizes[fields[0]] = int(fields[1])
+    return sizes
+
+
+def ram_symbols(elf):
+    """Returns (size, type, name) for every variable in RAM, largest first."""
+    output = subprocess.check_output(
+        [os.environ.get('AVR_NM', 'avr-nm'), '--size-sort', '-S', '-C', elf],
+        universal_newlines=True)
+
+    symbols = []
+    for line in output.splitlines():
+        fields = line.split(None, 3)
+        if len(fields) == 4 and fields[2] in RAM_SYMBOL_TYPES:
+            symbols.append((int(fields[1], 16), fields[2], fields[3]))
+    return sorted(symbols, reverse=True)
+
+
+def measured(args):
+    """Returns the largest ram_stack_peak and the smallest ram_free_min that
+    the log holds, or None if no record has a scan in it yet."""
+    layout = statevars.Layout.for_file(args.header, args.log)
+    if 'ram_stack_peak' not in layout.offsets:
+        sys.exit('%s has no RAM fields' % args.header)
+
+    peak = None
+    free = None
+    for record in layout.records(args.log):
+        if record['ram_stack_peak'] == 0:
+            continue
+        peak = max(peak or 0, record['ram_stack_peak'])
+        free = min(free if free is not None else RAM_SIZE,
+                   record['ram_free_min'])
+
+    return None if peak is None else (peak, free)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[1])
+    parser.add_argument('elf')
+    parser.add_argument('--log', help='a .dat file written by the same build')
+    parser.add_argument('--header', default=statevars.default_header(),
+                        help='statevars.h of the sketch that wrote the log')
+    parser.add_argument('--top', type=int, default=10,
+                        help='how many of the largest variables to list')
+    parser.add_argument('--min-free', type=int, default=0,
+                        help='fail if fewer bytes than this are left')
+    args = parser.parse_args()
+
+    sizes = section_sizes(args.elf)
+    static = sum(sizes.get(name, 0) for name in STATIC_SECTIONS)
+    left = RAM_SIZE - static
+
+    print('RAM budget of %s (%d bytes of SRAM)' % (args.elf, RAM_SIZE))
+    for name in STATIC_SECTIONS:
+        print('  %-8s %5d bytes' % (name, sizes.get(name, 0)))
+    print('  %-8s %5d bytes (%.1f%%)' % ('static', static,
+                                         100.0 * static / RAM_SIZE))
+    print('  heap and stack: %d bytes left' % left)
+
+    print('')
+    print('largest variables:')
+    for size, kind, name in ram_symbols(args.elf)[:args.top]:
+        section = '.bss' if kind in 'bB' else '.data'
+        print('  %5d  %-5s  %s' % (size, section, name))
+
+    smallest_gap = left
+    if args.log:
+        result = measured(args)
+        print('')
+        if result is None:
+            print('%s: no RAM scan recorded' % args.log)
+        else:
+            peak, free = result
+            print('%s: stack peak %d bytes, heap-to-stack gap min %d bytes' %
+                  (args.log, peak, free))
+            smallest_gap = free
+
+    if smallest_gap < args.min_free:
+        print('')
+        print('only %d bytes free; at least %d are needed' %
+              (smallest_gap, args.min_free))
+        return 1
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
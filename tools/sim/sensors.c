@@ -0,0 +1,278 @@
+/*
+ * file: sensors.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Defines the simulated sensors; see sensors.h. The noise is Gaussian and
+ * comes from a seeded generator, so a run can be repeated exactly.
+ *
+ * During a GPS dropout the receiver keeps sending GPGGA sentences, but with
+ * empty position fields and a fix indicator of 0, like the real one does.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sensors.h"
+
+#define DEG_TO_RAD(degrees) ((degrees) * M_PI / 180.0)
+#define EARTH_RADIUS_M      6371393.0
+#define KNOTS_PER_MPS       1.943844
+
+#define GPS_BAUD            9600
+#define GPS_BITS_PER_BYTE   10      // start + 8 data + stop
+#define GPS_START_HOUR      12      // UTC time of the first fix
+
+#define COMPASS_ADDRESS     0x60
+#define COMPASS_FIELD       400.0   // magnetometer reading of the horizontal field
+
+// Returns the next number from a xorshift64* generator
+static uint64_t next_random(uint64_t * state) {
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+
+  return *state * 0x2545F4914F6CDD1DULL;
+}
+
+// Returns a normally distributed number with the given standard deviation
+static double gaussian(uint64_t * state, double sigma) {
+  if (sigma == 0.0) {
+    return 0.0;
+  }
+
+  double u1 = ((next_random(state) >> 11) + 1.0) / 9007199254740993.0;
+  double u2 = (next_random(state) >> 11) / 9007199254740992.0;
+
+  return sigma * sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static double wrap360(double degrees) {
+  degrees = fmod(degrees, 360.0);
+
+  return (degrees < 0.0) ? degrees + 360.0 : degrees;
+}
+
+// Appends a sentence body (without the '$') along with its checksum
+static void queue_sentence(sensors_t * sensors, const char * body) {
+  char sentence[128];
+  uint8_t checksum = 0;
+  const char * c;
+
+  for (c = body; *c != '\0'; c++) {
+    checksum ^= *c;
+  }
+
+  int len = snprintf(sentence, sizeof(sentence), "$%s*%02X\r\n", body,
+                     checksum);
+  if (len < 0 || sensors->nmea_len + len > SENSORS_NMEA_QUEUE_SIZE) {
+    return;
+  }
+
+  int i;
+  for (i = 0; i < len; i++) {
+    uint16_t slot = (sensors->nmea_head + sensors->nmea_len) %
+        SENSORS_NMEA_QUEUE_SIZE;
+    sensors->nmea[slot] = sentence[i];
+    sensors->nmea_len++;
+  }
+
+  return;
+}
+
+// Formats a coordinate as NMEA (d)ddmm.mmmm plus its hemisphere
+static void format_coordinate(char * out, size_t size, double degrees,
+                              uint8_t degree_digits, char positive,
+                              char negative) {
+  char hemisphere = (degrees < 0.0) ? negative : positive;
+  double magnitude = fabs(degrees);
+  int whole = (int) magnitude;
+  double minutes = (magnitude - whole) * 60.0;
+
+  snprintf(out, size, "%0*d%07.4f,%c", degree_digits, whole, minutes,
+           hemisphere);
+
+  return;
+}
+
+// Sends the sentences for a fix of the car's current position
+static void queue_fix(sensors_t * sensors, double fix_s) {
+  const sensor_params_t * p = sensors->params;
+  const vehicle_t * car = sensors->car;
+  char body[112];
+  char utc[16];
+  char lat[24];
+  char lon[24];
+
+  double seconds = fix_s;
+  int hours = GPS_START_HOUR + (int) (seconds / 3600.0);
+  seconds -= (hours - GPS_START_HOUR) * 3600.0;
+  int minutes = (int) (seconds / 60.0);
+  seconds -= minutes * 60.0;
+  snprintf(utc, sizeof(utc), "%02d%02d%06.3f", hours % 24, minutes, seconds);
+
+  uint8_t dropped = (fix_s >= p->gps_dropout_start_s &&
+                     fix_s < p->gps_dropout_start_s + p->gps_dropout_s);
+
+  if (dropped) {
+    snprintf(body, sizeof(body), "GPGGA,%s,,,,,0,00,,,M,,M,,", utc);
+    queue_sentence(sensors, body);
+    return;
+  }
+
+  double north_m = car->y_m + gaussian(&sensors->rng, p->gps_noise_m);
+  double east_m = car->x_m + gaussian(&sensors->rng, p->gps_noise_m);
+  double latitude = p->origin_lat_deg +
+      north_m / EARTH_RADIUS_M * 180.0 / M_PI;
+  double longitude = p->origin_long_deg +
+      east_m / (EARTH_RADIUS_M * cos(DEG_TO_RAD(p->origin_lat_deg))) *
+      180.0 / M_PI;
+
+  format_coordinate(lat, sizeof(lat), latitude, 2, 'N', 'S');
+  format_coordinate(lon, sizeof(lon), longitude, 3, 'E', 'W');
+
+  double speed_kt = fabs(car->speed_mps) * KNOTS_PER_MPS;
+
+  snprintf(body, sizeof(body), "GPGGA,%s,%s,%s,1,08,0.9,1624.0,M,-21.3,M,,",
+           utc, lat, lon);
+  queue_sentence(sensors, body);
+
+  queue_sentence(sensors, "GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,0.9,2.1");
+
+  snprintf(body, sizeof(body), "GPRMC,%s,A,%s,%s,%.2f,%.2f,181026,,,A",
+           utc, lat, lon, speed_kt, car->heading_deg);
+  queue_sentence(sensors, body);
+
+  snprintf(body, sizeof(body), "GPVTG,%.2f,T,,M,%.2f,N,%.2f,K,A",
+           car->heading_deg, speed_kt, speed_kt * 1.852);
+  queue_sentence(sensors, body);
+
+  sensors->fixes++;
+
+  return;
+}
+
+// Fills in the compass registers from the car's current attitude
+static void sample_compass(sensors_t * sensors) {
+  const sensor_params_t * p = sensors->params;
+  uint8_t * regs = sensors->compass_regs;
+
+  double magnetic = wrap360(sensors->car->heading_deg - p->declination_deg +
+                            p->compass_bias_deg +
+                            gaussian(&sensors->rng, p->compass_noise_deg));
+  uint16_t heading = (uint16_t) (magnetic * 10.0 + 0.5) % 3600;
+
+  regs[1] = (uint8_t) (heading * 256UL / 3600);
+  regs[2] = heading >> 8;
+  regs[3] = heading & 0xFF;
+  regs[4] = 0;
+  regs[5] = 0;
+
+  int16_t raw[6] = {
+    (int16_t) (COMPASS_FIELD * cos(DEG_TO_RAD(magnetic))),
+    (int16_t) (-COMPASS_FIELD * sin(DEG_TO_RAD(magnetic))),
+    -300, 0, 0, 1000
+  };
+  int i;
+  for (i = 0; i < 6; i++) {
+    regs[10 + 2 * i] = (uint16_t) raw[i] >> 8;
+    regs[11 + 2 * i] = (uint16_t) raw[i] & 0xFF;
+  }
+
+  return;
+}
+
+static uint8_t compass_start(void * context, uint8_t is_read) {
+  sensors_t * sensors = context;
+
+  if (is_read) {
+    sample_compass(sensors);
+  }
+
+  return 1;
+}
+
+static uint8_t compass_write(void * context, uint8_t data) {
+  sensors_t * sensors = context;
+
+  sensors->compass_reg = data;
+
+  return 1;
+}
+
+static uint8_t compass_read(void * context) {
+  sensors_t * sensors = context;
+  uint8_t reg = sensors->compass_reg++;
+
+  return (reg < sizeof(sensors->compass_regs)) ?
+      sensors->compass_regs[reg] : 0;
+}
+
+void sensors_default_params(sensor_params_t * params) {
+  params->origin_lat_deg = 40.0150;       // Boulder, Colorado
+  params->origin_long_deg = -105.2705;
+  params->gps_rate_hz = 1.0;
+  params->gps_latency_s = 0.1;
+  params->gps_noise_m = 1.0;
+  params->gps_dropout_start_s = 0.0;
+  params->gps_dropout_s = 0.0;
+  params->compass_bias_deg = 0.0;
+  params->compass_noise_deg = 1.0;
+  params->declination_deg = 8.52;
+  params->ticks_per_m = 7.6;
+
+  return;
+}
+
+void sensors_init(sensors_t * sensors, const sensor_params_t * params,
+                  const vehicle_t * car, uint64_t seed) {
+  memset(sensors, 0, sizeof(*sensors));
+
+  sensors->params = params;
+  sensors->car = car;
+  sensors->rng = seed * 0x9E3779B97F4A7C15ULL + 1;
+
+  sensors->next_fix_s = 1.0 / params->gps_rate_hz;
+
+  sensors->compass.address = COMPASS_ADDRESS;
+  sensors->compass.context = sensors;
+  sensors->compass.start = compass_start;
+  sensors->compass.write = compass_write;
+  sensors->compass.read = compass_read;
+  hal_host_twi_attach(&sensors->compass);
+
+  return;
+}
+
+uint64_t sensors_update(sensors_t * sensors, uint64_t now) {
+  const sensor_params_t * p = sensors->params;
+  double now_s = (double) now / F_CPU;
+  uint64_t byte_cycles = F_CPU * GPS_BITS_PER_BYTE / GPS_BAUD;
+
+  // The odometer magnet passes the sensor once per tick
+  uint32_t ticks = (uint32_t) (sensors->car->distance_m * p->ticks_per_m);
+  while (sensors->ticks < ticks) {
+    sensors->ticks++;
+    hal_host_capture(5);
+  }
+
+  if (now_s >= sensors->next_fix_s + p->gps_latency_s) {
+    queue_fix(sensors, sensors->next_fix_s);
+    sensors->next_fix_s += 1.0 / p->gps_rate_hz;
+  }
+
+  if (sensors->nmea_len > 0 && now >= sensors->next_byte_at) {
+    hal_host_usart2_rx(sensors->nmea[sensors->nmea_head]);
+    sensors->nmea_head = (sensors->nmea_head + 1) % SENSORS_NMEA_QUEUE_SIZE;
+    sensors->nmea_len--;
+    sensors->next_byte_at = now + byte_cycles;
+  }
+
+  uint64_t next = (uint64_t) ((sensors->next_fix_s + p->gps_latency_s) *
+                              F_CPU);
+  if (sensors->nmea_len > 0 && sensors->next_byte_at < next) {
+    next = sensors->next_byte_at;
+  }
+
+  return next;
+}
@@ -0,0 +1,67 @@
+/*
+ * file: sensors.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Lists the types and functions of the simulated sensors. Each one feeds the
+ * firmware through the same peripheral the real sensor uses:
+ *   GPS         NMEA sentences (GPGGA, GPGSA, GPRMC, GPVTG) sent byte by byte
+ *               into USART2 at 9600 baud, once per fix
+ *   compass     a CMPS10 on the TWI bus that answers register reads
+ *   odometer    a Timer5 input capture for every tick of the wheel magnet
+ *
+ * sensors_update() is called from the simulator's event hook and returns the
+ * CPU cycle at which it wants to be called next.
+ */
+#ifndef _SENSORS_H_
+#define _SENSORS_H_
+
+#include <stdint.h>
+
+#include "hal_host.h"
+#include "vehicle.h"
+
+#define SENSORS_NMEA_QUEUE_SIZE   512
+
+typedef struct {
+  double origin_lat_deg;        // where the car starts
+  double origin_long_deg;
+  double gps_rate_hz;
+  double gps_latency_s;         // from the fix to its first byte
+  double gps_noise_m;           // standard deviation, north and east
+  double gps_dropout_start_s;   // no fix from here...
+  double gps_dropout_s;         // ...for this long
+  double compass_bias_deg;
+  double compass_noise_deg;     // standard deviation
+  double declination_deg;       // true heading - magnetic heading
+  double ticks_per_m;           // odometer ticks per meter driven
+} sensor_params_t;
+
+typedef struct {
+  const sensor_params_t * params;
+  const vehicle_t * car;
+  uint64_t rng;
+
+  // GPS
+  double next_fix_s;
+  uint64_t next_byte_at;
+  char nmea[SENSORS_NMEA_QUEUE_SIZE];
+  uint16_t nmea_head;
+  uint16_t nmea_len;
+  uint32_t fixes;
+
+  // Compass
+  hal_host_twi_device_t compass;
+  uint8_t compass_regs[32];
+  uint8_t compass_reg;
+
+  // Odometer
+  uint32_t ticks;
+} sensors_t;
+
+void sensors_default_params(sensor_params_t * params);
+void sensors_init(sensors_t * sensors, const sensor_params_t * params,
+                  const vehicle_t * car, uint64_t seed);
+uint64_t sensors_update(sensors_t * sensors, uint64_t now);
+
+#endif // #ifndef _SENSORS_H_
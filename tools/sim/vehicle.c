@@ -0,0 +1,102 @@
+/*
+ * file: vehicle.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Defines the simulated car; see vehicle.h. The default parameters are those
+ * of the 1/10 scale car the robot is built on, measured roughly.
+ */
+#include <math.h>
+
+#include "vehicle.h"
+
+#define DEG_TO_RAD(degrees) ((degrees) * M_PI / 180.0)
+#define RAD_TO_DEG(radians) ((radians) * 180.0 / M_PI)
+
+// The steering and throttle pulse widths at neutral and at full deflection;
+// see mobility.h
+#define NEUTRAL_US            1500.0
+#define FULL_STEER_US         400.0
+
+// Servos and ESCs ignore anything outside this range, e.g. no pulses at all
+#define MIN_PULSE_US          800
+#define MAX_PULSE_US          2200
+
+void vehicle_default_params(vehicle_params_t * params) {
+  params->wheelbase_m = 0.33;
+  params->max_steer_deg = 25.0;
+  params->steer_rate_dps = 250.0;
+  params->throttle_deadband_us = 30.0;
+  params->mps_per_us = 0.0095;
+  params->speed_lag_s = 0.4;
+
+  return;
+}
+
+void vehicle_init(vehicle_t * car, double heading_deg) {
+  car->x_m = 0.0;
+  car->y_m = 0.0;
+  car->heading_deg = heading_deg;
+  car->speed_mps = 0.0;
+  car->steer_deg = 0.0;
+  car->distance_m = 0.0;
+
+  return;
+}
+
+void vehicle_step(vehicle_t * car, const vehicle_params_t * params,
+                  uint16_t steering_us, uint16_t throttle_us, double dt_s) {
+  // Without a valid pulse the servo holds still and the ESC idles
+  uint8_t steering_valid = (steering_us >= MIN_PULSE_US &&
+                            steering_us <= MAX_PULSE_US);
+
+  if (throttle_us < MIN_PULSE_US || throttle_us > MAX_PULSE_US) {
+    throttle_us = NEUTRAL_US;
+  }
+
+  // Steering servo
+  double steer_target = steering_valid ?
+      (steering_us - NEUTRAL_US) / FULL_STEER_US * params->max_steer_deg :
+      car->steer_deg;
+  double max_change = params->steer_rate_dps * dt_s;
+  double change = steer_target - car->steer_deg;
+
+  if (change > max_change) {
+    change = max_change;
+  } else if (change < -max_change) {
+    change = -max_change;
+  }
+  car->steer_deg += change;
+
+  // Drive motor
+  double throttle = throttle_us - NEUTRAL_US;
+  double speed_target = 0.0;
+
+  if (throttle > params->throttle_deadband_us) {
+    speed_target = (throttle - params->throttle_deadband_us) *
+        params->mps_per_us;
+  } else if (throttle < -params->throttle_deadband_us) {
+    speed_target = (throttle + params->throttle_deadband_us) *
+        params->mps_per_us;
+  }
+
+  car->speed_mps += (speed_target - car->speed_mps) * dt_s /
+      (params->speed_lag_s + dt_s);
+
+  // Kinematic bicycle; turning left lowers the heading
+  double yaw_rate = car->speed_mps / params->wheelbase_m *
+      tan(DEG_TO_RAD(car->steer_deg));
+  double heading_rad = DEG_TO_RAD(car->heading_deg);
+
+  car->x_m += car->speed_mps * sin(heading_rad) * dt_s;
+  car->y_m += car->speed_mps * cos(heading_rad) * dt_s;
+  car->distance_m += fabs(car->speed_mps) * dt_s;
+
+  car->heading_deg = fmod(car->heading_deg - RAD_TO_DEG(yaw_rate * dt_s),
+                          360.0);
+  if (car->heading_deg < 0.0) {
+    car->heading_deg += 360.0;
+  }
+
+  return;
+}
@@ -0,0 +1,42 @@
+/*
+ * file: vehicle.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Lists the types and functions of the simulated car. The car is a kinematic
+ * bicycle: the front wheel angle and the speed set the turn rate. The steering
+ * servo follows its pulse width at a limited rate, and the drive motor's speed
+ * follows the throttle pulse width with a first-order lag.
+ *
+ * Positions are meters east (x) and north (y) of the starting point; headings
+ * are true degrees, clockwise from north.
+ */
+#ifndef _VEHICLE_H_
+#define _VEHICLE_H_
+
+#include <stdint.h>
+
+typedef struct {
+  double wheelbase_m;
+  double max_steer_deg;         // front wheel angle at full left or right
+  double steer_rate_dps;        // how fast the servo turns the wheels
+  double throttle_deadband_us;  // no drive within this much of neutral
+  double mps_per_us;            // top speed per microsecond past the deadband
+  double speed_lag_s;           // time constant of the drive motor
+} vehicle_params_t;
+
+typedef struct {
+  double x_m;
+  double y_m;
+  double heading_deg;
+  double speed_mps;             // negative when reversing
+  double steer_deg;             // positive turns left
+  double distance_m;            // distance rolled by the odometer wheel
+} vehicle_t;
+
+void vehicle_default_params(vehicle_params_t * params);
+void vehicle_init(vehicle_t * car, double heading_deg);
+void vehicle_step(vehicle_t * car, const vehicle_params_t * params,
+                  uint16_t steering_us, uint16_t throttle_us, double dt_s);
+
+#endif // #ifndef _VEHICLE_H_
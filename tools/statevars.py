@@ -0,0 +1,295 @@
+"""
+file: statevars.py
+created: 20261018
+author(s): mr-augustine
+
+Reads the statevars records that the robot writes to the SD card. The record
+layout is taken straight from a sketch's statevars.h so that the host tools
+don't need to be updated every time a field is added.
+
+The AVR doesn't pad structs and stores values little-endian, so each field
+starts right where the previous field ended. Fields that are themselves
+structs (e.g., sample_meta_t) are flattened into dotted names such as
+'gps_meta.timestamp'.
+
+The host simulator (tools/sim) writes the same records with this machine's
+struct layout, where every field is aligned to its size. statevars.h now
+orders its fields so the two layouts are the same, but Layout.for_file() still
+picks whichever of the two a .dat file was written with, for older logs.
+
+Records hold all four raw GPS sentences unless the sketch's kintobor_config.h
+sets STATEVARS_ALL_GPS_SENTENCES to 0, which drops gps_sentence1 (GPGSA) and
+gps_sentence3 (GPVTG). The layout follows that setting like any other; a
+record without those fields simply has no such names.
+"""
+import os
+import re
+import struct
+
+PREFIX = 0xDADAFEED
+SUFFIX = 0xCAFEBABE
+
+TYPE_FORMATS = {
+    'uint8_t': 'B',
+    'int8_t': 'b',
+    'uint16_t': 'H',
+    'int16_t': 'h',
+    'uint32_t': 'I',
+    'int32_t': 'i',
+    'float': 'f',
+    'char': 'c',
+}
+
+_DEFINE_RE = re.compile(r'^\s*#\s*define\s+(\w+)(?:\s+(.+?))?\s*$')
+_INCLUDE_RE = re.compile(r'^\s*#\s*include\s+"([^"]+)"')
+_CONDITIONAL_RE = re.compile(
+    r'^\s*#\s*(if|ifdef|ifndef|elif|else|endif)\b(.*)$')
+_DEFINED_RE = re.compile(r'\bdefined\s*(?:\(\s*(\w+)\s*\)|(\w+))')
+_NAME_RE = re.compile(r'\b[A-Za-z_]\w*\b')
+_FIELD_RE = re.compile(r'^\s*(\w+)\s+(\w+)\s*(?:\[([^\]]+)\])?\s*;')
+_STRUCT_RE = re.compile(r'typedef\s+struct\s*\w*\s*\{(.*?)\}\s*(\w+)\s*;',
+                        re.S)
+
+
+def _strip_comments(text):
+    text = re.sub(r'/\*.*?\*/', '', text, flags=re.S)
+    text = re.sub(r'//[^\n]*', '', text)
+    return text.replace('\\\n', ' ')
+
+
+def _expand(expr, defines):
+    """Replaces the defined names in an expression with their values, and
+    those values' names with theirs, and so on."""
+    for _ in range(16):
+        if not any(name in defines for name in _NAME_RE.findall(expr)):
+            break
+        expr = _NAME_RE.sub(
+            lambda m: ('(%s)' % defines[m.group(0)]
+                       if m.group(0) in defines else m.group(0)), expr)
+    return expr
+
+
+def _evaluate(expr, defines):
+    """Evaluates a numeric macro expression using the known defines."""
+    expr = _expand(expr, defines)
+    expr = re.sub(r'\b([0-9]+)[uUlL]+\b', r'\1', expr)
+    expr = expr.replace('/', '//')
+    try:
+        return int(eval(expr, {'__builtins__': {}}))
+    except Exception:
+        return None
+
+
+def _condition(expr, defines):
+    """Evaluates the expression of an #if or #elif. As in the C preprocessor,
+    a name that isn't defined counts as 0."""
+    expr = _DEFINED_RE.sub(
+        lambda m: '1' if (m.group(1) or m.group(2)) in defines else '0', expr)
+    expr = _NAME_RE.sub(lambda m: m.group(0) if m.group(0) in defines else '0',
+                        _expand(expr, defines))
+    expr = expr.replace('&&', ' and ').replace('||', ' or ')
+    expr = re.sub(r'!(?!=)', ' not ', expr)
+    return bool(_evaluate(expr, {}))
+
+
+def _preprocess(header_path, defines, seen, parts):
+    """Appends the lines of a header (and of the local headers it includes)
+    that the C preprocessor would keep to parts, and collects the #defines on
+    those lines. Conditionals are evaluated with the defines seen
+    so far, so a sketch's kintobor_config.h selects the statevars fields."""
+    header_path = os.path.abspath(header_path)
+    if header_path in seen or not os.path.exists(header_path):
+        return
+    seen.add(header_path)
+
+    with open(header_path) as f:
+        text = _strip_comments(f.read())
+
+    # One entry per open conditional: (taking this branch, taken a branch)
+    stack = []
+    for line in text.splitlines():
+        m = _CONDITIONAL_RE.match(line)
+        if m:
+            directive, expr = m.group(1), m.group(2).strip()
+            outer = all(taking for taking, _ in stack)
+            if directive in ('if', 'ifdef', 'ifndef'):
+                if directive == 'ifdef':
+                    taking = expr in defines
+                elif directive == 'ifndef':
+                    taking = expr not in defines
+                else:
+                    taking = outer and _condition(expr, defines)
+                taking = outer and taking
+                stack.append((taking, taking))
+            elif directive == 'elif' and stack:
+                _, taken = stack.pop()
+                outer = all(taking for taking, _ in stack)
+                taking = outer and not taken and _condition(expr, defines)
+                stack.append((taking, taken or taking))
+            elif directive == 'else' and stack:
+                _, taken = stack.pop()
+                outer = all(taking for taking, _ in stack)
+                stack.append((outer and not taken, True))
+            elif directive == 'endif' and stack:
+                stack.pop()
+            continue
+
+        if not all(taking for taking, _ in stack):
+            continue
+
+        m = _INCLUDE_RE.match(line)
+        if m:
+            included = os.path.join(os.path.dirname(header_path), m.group(1))
+            _preprocess(included, defines, seen, parts)
+            continue
+
+        m = _DEFINE_RE.match(line)
+        if m:
+            # Values that aren't numbers (yet) are kept as text
+            value = m.group(2) or ''
+            number = _evaluate(value, defines)
+            defines[m.group(1)] = value if number is None else number
+
+        parts.append(line)
+
+
+def read_sources(header_path, defines=None):
+    """Returns the comment-free text of a header and of the local headers it
+    includes, leaving out what conditionals exclude. defines holds any macros
+    defined before the header (e.g., on the compiler's command line)."""
+    parts = []
+    _preprocess(header_path, dict(defines or {}), set(), parts)
+    return '\n'.join(parts)
+
+
+def read_defines(header_path, defines=None):
+    """Collects the numeric #defines of a header and the local headers it
+    includes. defines holds any macros defined before the header."""
+    defines = dict(defines or {})
+    _preprocess(header_path, defines, set(), [])
+    return dict((name, value) for name, value in defines.items()
+                if isinstance(value, int))
+
+
+def _align(offset, alignment):
+    return (offset + alignment - 1) // alignment * alignment
+
+
+class Layout(object):
+    """The byte layout of statevars_t as parsed from statevars.h. The layout
+    is packed, as on the AVR, unless aligned is set."""
+
+    def __init__(self, header_path, aligned=False):
+        self.defines = read_defines(header_path)
+        self.aligned = aligned
+        self.fields = []    # (name, format char, count, offset)
+        self.offsets = {}
+
+        structs = {}
+        for body, name in _STRUCT_RE.findall(read_sources(header_path)):
+            structs[name] = body
+
+        if 'statevars_t' not in structs:
+            raise ValueError('no statevars_t found in %s' % header_path)
+
+        self.size = _align(
+            self._add_fields(structs['statevars_t'], '', 0, structs),
+            self._alignment('statevars_t', structs))
+
+    @classmethod
+    def for_file(cls, header_path, dat_path):
+        """Returns the layout (packed or aligned) that the records in a .dat
+        file were written with. Falls back to packed if neither fits."""
+        for aligned in (False, True):
+            layout = cls(header_path, aligned)
+            for _ in layout.records(dat_path):
+                return layout
+        return cls(header_path)
+
+    def _alignment(self, ctype, structs):
+        """Returns the alignment of a type: 1 when packed, otherwise its size
+        (or its largest member's, for a struct)."""
+        if not self.aligned:
+            return 1
+
+        if ctype in structs:
+            return max([self._alignment(fm.group(1), structs)
+                        for fm in map(_FIELD_RE.match,
+                                      structs[ctype].splitlines())
+                        if fm is not None] or [1])
+
+        if ctype not in TYPE_FORMATS:
+            raise ValueError('unknown statevars type %s' % ctype)
+
+        return struct.calcsize('<' + TYPE_FORMATS[ctype])
+
+    def _add_fields(self, body, prefix, offset, structs):
+        """Lays out the fields of a struct body starting at offset and returns
+        the offset just past the last field."""
+        for line in body.splitlines():
+            fm = _FIELD_RE.match(line)
+            if fm is None:
+                continue
+
+            ctype, name, count = fm.groups()
+            count = 1 if count is None else _evaluate(count, self.defines)
+            name = prefix + name
+            alignment = self._alignment(ctype, structs)
+            offset = _align(offset, alignment)
+
+            if ctype in structs:
+                self.offsets[name] = offset
+                for i in range(count):
+                    element = name if count == 1 else '%s[%d]' % (name, i)
+                    offset = _align(
+                        self._add_fields(structs[ctype], element + '.',
+                                         offset, structs),
+                        alignment)
+                continue
+
+            fmt = TYPE_FORMATS[ctype]
+
+            self.fields.append((name, fmt, count, offset))
+            self.offsets[name] = offset
+            offset += struct.calcsize('<' + fmt) * count
+
+        return offset
+
+    def decode(self, raw):
+        """Converts one raw record into a dict of field values. Arrays become
+        lists, except char arrays which become bytes."""
+        record = {}
+        for name, fmt, count, offset in self.fields:
+            if fmt == 'c':
+                record[name] = raw[offset:offset + count]
+            elif count == 1:
+                record[name] = struct.unpack_from('<' + fmt, raw, offset)[0]
+            else:
+                record[name] = list(
+                    struct.unpack_from('<%d%s' % (count, fmt), raw, offset))
+        return record
+
+    def records(self, path):
+        """Yields every intact record in a .dat file. Records whose prefix or
+        suffix is damaged are skipped."""
+        prefix = struct.pack('<I', PREFIX)
+
+        with open(path, 'rb') as f:
+            data = f.read()
+
+        pos = data.find(prefix)
+        while pos != -1 and pos + self.size <= len(data):
+            raw = data[pos:pos + self.size]
+            suffix, = struct.unpack_from('<I', raw, self.size - 4)
+
+            if suffix == SUFFIX:
+                yield self.decode(raw)
+                pos = data.find(prefix, pos + self.size)
+            else:
+                pos = data.find(prefix, pos + 1)
+
+
+def default_header():
+    """The statevars.h of the sketch the tools were last updated for."""
+    here = os.path.dirname(os.path.abspath(__file__))
+    return os.path.join(here, '..', 'demo_sgconzm', 'statevars.h')
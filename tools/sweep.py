@@ -0,0 +1,274 @@
+#!/usr/bin/env python3
+"""
+file: sweep.py
+created: 20261018
+author(s): mr-augustine
+
+Runs many simulated missions (see tools/sim) and tabulates how well each
+controller setting held its heading.
+
+The firmware settings (the gains, TICKS_PER_METER, and the heading blend) are
+compile-time constants in kintobor.c, so every combination of them gets its
+own build of the simulator. Every build then drives every combination of the
+scenario settings (GPS noise and dropouts, compass bias and noise, starting
+heading), each with --seeds different random seeds.
+
+Every mission is a process of its own, and a pool of --jobs threads (one per
+core by default) keeps that many running at once. The missions share nothing,
+so the sweep scales with the number of cores.
+
+A dropout is given as START:LENGTH in seconds, or none.
+
+Usage: sweep.py [--k-prop 2,2.78,4] [--k-rate 0] [--k-integral 0]
+                [--ticks-per-meter 7.6] [--blend mid,compass]
+                [--gps-noise 1] [--gps-dropout none,2:3] [--compass-bias 0]
+                [--compass-noise 1] [--start-heading 270]
+                [--seeds 10] [--jobs N] [--csv results.csv]
+"""
+import argparse
+import concurrent.futures
+import csv
+import itertools
+import json
+import os
+import subprocess
+import sys
+import time
+
+SIM_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'sim')
+
+BLENDS = {
+    'mid': 'NAV_HEADING_MID_ANGLE',
+    'compass': 'NAV_HEADING_COMPASS',
+}
+
+# (option, kintobor.c define) for the settings that need their own build
+FIRMWARE_SETTINGS = [
+    ('k_prop', 'K_PROP'),
+    ('k_rate', 'K_RATE'),
+    ('k_integral', 'K_INTEGRAL'),
+    ('ticks_per_meter', 'TICKS_PER_METER'),
+    ('blend', 'NAV_HEADING_BLEND'),
+]
+
+# (option, sim flag) for the settings that every build is run with
+SCENARIO_SETTINGS = [
+    ('gps_noise', '--gps-noise'),
+    ('gps_dropout', '--gps-dropout'),
+    ('compass_bias', '--compass-bias'),
+    ('compass_noise', '--compass-noise'),
+    ('start_heading', '--start-heading'),
+]
+
+
+def number_list(text):
+    return [float(v) for v in text.split(',')]
+
+
+def blend_list(text):
+    blends = text.split(',')
+    for blend in blends:
+        if blend not in BLENDS:
+            raise argparse.ArgumentTypeError(
+                'unknown blend %s; choose from %s' %
+                (blend, ', '.join(sorted(BLENDS))))
+    return blends
+
+
+def dropout_list(text):
+    dropouts = []
+    for item in text.split(','):
+        if item == 'none':
+            dropouts.append(None)
+            continue
+        try:
+            start, length = (float(v) for v in item.split(':'))
+        except ValueError:
+            raise argparse.ArgumentTypeError(
+                'a dropout is START:LENGTH or none, not %s' % item)
+        dropouts.append((start, length))
+    return dropouts
+
+
+def percentile(values, fraction):
+    ordered = sorted(values)
+    index = min(len(ordered) - 1, int(fraction * len(ordered)))
+    return ordered[index]
+
+
+def format_value(value):
+    if value is None:
+        return 'none'
+    if isinstance(value, tuple):
+        return '%g:%g' % value
+    if isinstance(value, float):
+        return '%g' % value
+    return str(value)
+
+
+def build(variant):
+    """Builds the simulator with a variant's firmware settings and returns the
+    path of the program."""
+    tag = '_'.join('%s%s' % (option, format_value(variant[option]))
+                   for option, _ in FIRMWARE_SETTINGS)
+    build_dir = os.path.join(SIM_DIR, 'build', 'sweep', tag)
+
+    defines = []
+    for option, define in FIRMWARE_SETTINGS:
+        value = variant[option]
+        if option == 'blend':
+            value = BLENDS[value]
+        defines.append('-D%s=%s' % (define, format_value(value)))
+
+    result = subprocess.run(
+        ['make', '-s', '-C', SIM_DIR, 'BUILD=' + build_dir,
+         'DEFINES=' + ' '.join(defines)],
+        stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+        universal_newlines=True)
+    if result.returncode != 0:
+        raise RuntimeError('building %s failed:\n%s' % (tag, result.stdout))
+
+    return os.path.join(build_dir, 'sim')
+
+
+def run_mission(program, scenario, seed):
+    """Runs one mission and returns the simulator's JSON result."""
+    command = [program, '--seed', str(seed)]
+    for option, flag in SCENARIO_SETTINGS:
+        value = scenario[option]
+        if value is None:
+            continue
+        if isinstance(value, tuple):
+            value = '%g,%g' % value
+        command += [flag, format_value(value)]
+
+    output = subprocess.run(command, stdout=subprocess.PIPE, check=True,
+                            universal_newlines=True).stdout
+    return json.loads(output)
+
+
+def product(args, settings):
+    """Returns a dict per combination of the given settings' values."""
+    names = [option for option, _ in settings]
+    return [dict(zip(names, values))
+            for values in itertools.product(*(getattr(args, name)
+                                              for name in names))]
+
+
+def summarise(variant, results):
+    rms = [r['heading_rms_deg'] for r in results]
+    return {
+        'variant': variant,
+        'runs': len(results),
+        'rms_mean': sum(rms) / len(rms),
+        'rms_p95': percentile(rms, 0.95),
+        'max': max(r['heading_max_deg'] for r in results),
+        'settling_mean': (sum(r['settling_s'] for r in results) /
+                          len(results)),
+        'overruns': sum(r['overruns'] for r in results),
+        'unstopped': sum(1 for r in results if not r['stopped']),
+    }
+
+
+def print_table(summaries):
+    headings = ['k_prop', 'k_rate', 'k_int', 'ticks/m', 'blend', 'runs',
+                'rms', 'rms p95', 'max', 'settle s', 'overruns', 'unstopped']
+    rows = []
+    for s in sorted(summaries, key=lambda s: s['rms_mean']):
+        v = s['variant']
+        rows.append([format_value(v['k_prop']), format_value(v['k_rate']),
+                     format_value(v['k_integral']),
+                     format_value(v['ticks_per_meter']), v['blend'],
+                     str(s['runs']), '%.2f' % s['rms_mean'],
+                     '%.2f' % s['rms_p95'], '%.1f' % s['max'],
+                     '%.2f' % s['settling_mean'], str(s['overruns']),
+                     str(s['unstopped'])])
+
+    widths = [max(len(row[i]) for row in rows + [headings])
+              for i in range(len(headings))]
+    for row in [headings] + rows:
+        print('  '.join(cell.rjust(width)
+                        for cell, width in zip(row, widths)))
+
+
+def write_csv(path, rows):
+    fields = ([option for option, _ in FIRMWARE_SETTINGS] +
+              [option for option, _ in SCENARIO_SETTINGS] +
+              ['seed', 'heading_rms_deg', 'heading_max_deg', 'settling_s',
+               'distance_m', 'overruns', 'stopped'])
+
+    with open(path, 'w', newline='') as f:
+        writer = csv.writer(f)
+        writer.writerow(fields)
+        for variant, scenario, result in rows:
+            values = dict(variant)
+            values.update(scenario)
+            values.update(result)
+            writer.writerow([format_value(values[field]) for field in fields])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[1])
+    parser.add_argument('--k-prop', type=number_list, default=[2.7777777777777])
+    parser.add_argument('--k-rate', type=number_list, default=[0.0])
+    parser.add_argument('--k-integral', type=number_list, default=[0.0])
+    parser.add_argument('--ticks-per-meter', type=number_list, default=[7.6])
+    parser.add_argument('--blend', type=blend_list, default=['mid'])
+    parser.add_argument('--gps-noise', type=number_list, default=[1.0])
+    parser.add_argument('--gps-dropout', type=dropout_list, default=[None])
+    parser.add_argument('--compass-bias', type=number_list, default=[0.0])
+    parser.add_argument('--compass-noise', type=number_list, default=[1.0])
+    parser.add_argument('--start-heading', type=number_list, default=[270.0])
+    parser.add_argument('--seeds', type=int, default=10,
+                        help='missions per variant and scenario')
+    parser.add_argument('--jobs', type=int, default=os.cpu_count() or 1,
+                        help='missions to run at once (default: one per core)')
+    parser.add_argument('--csv', help='also write every mission to this file')
+    args = parser.parse_args()
+
+    variants = product(args, FIRMWARE_SETTINGS)
+    scenarios = product(args, SCENARIO_SETTINGS)
+    missions = len(variants) * len(scenarios) * args.seeds
+
+    print('%d builds x %d scenarios x %d seeds = %d missions on %d threads' %
+          (len(variants), len(scenarios), args.seeds, missions, args.jobs))
+
+    with concurrent.futures.ThreadPoolExecutor(args.jobs) as pool:
+        try:
+            programs = list(pool.map(build, variants))
+        except RuntimeError as e:
+            sys.exit(str(e))
+
+        started = time.time()
+        futures = []
+        for variant, program in zip(variants, programs):
+            for scenario in scenarios:
+                for seed in range(1, args.seeds + 1):
+                    futures.append((variant, scenario, pool.submit(
+                        run_mission, program, scenario, seed)))
+
+        rows = [(variant, scenario, future.result())
+                for variant, scenario, future in futures]
+        elapsed = time.time() - started
+
+    summaries = []
+    for i, variant in enumerate(variants):
+        per_variant = len(scenarios) * args.seeds
+        results = [result for _, _, result in
+                   rows[i * per_variant:(i + 1) * per_variant]]
+        summaries.append(summarise(variant, results))
+
+    print_table(summaries)
+
+    sim_seconds = sum(result['sim_s'] for _, _, result in rows)
+    print('%d missions in %.1f s (%.0f missions/s, %.0fx real time)' %
+          (missions, elapsed, missions / elapsed, sim_seconds / elapsed))
+
+    if args.csv:
+        write_csv(args.csv, rows)
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
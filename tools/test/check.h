@@ -0,0 +1,64 @@
+/*
+ * file: check.h
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * A few checks for the host unit tests. A failed check prints where it is and
+ * what it compared, and the test keeps going; check_summary() prints how many
+ * checks failed and returns the test program's exit status.
+ */
+#ifndef _CHECK_H_
+#define _CHECK_H_
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static unsigned checks_run;
+static unsigned checks_failed;
+
+static void check_failed(const char * file, int line, const char * what) {
+  fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what);
+  checks_failed++;
+
+  return;
+}
+
+#define CHECK(cond) \
+  do { \
+    checks_run++; \
+    if (!(cond)) { \
+      check_failed(__FILE__, __LINE__, #cond); \
+    } \
+  } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+  do { \
+    double check_a = (actual); \
+    double check_e = (expected); \
+    checks_run++; \
+    if (!(fabs(check_a - check_e) <= (tolerance))) { \
+      fprintf(stderr, "  %s is %f; expected %f +/- %f\n", \
+              #actual, check_a, check_e, (double) (tolerance)); \
+      check_failed(__FILE__, __LINE__, #actual " near " #expected); \
+    } \
+  } while (0)
+
+#define CHECK_STR(actual, expected) \
+  do { \
+    checks_run++; \
+    if (strcmp((actual), (expected)) != 0) { \
+      fprintf(stderr, "  %s is \"%s\"; expected \"%s\"\n", \
+              #actual, (actual), (expected)); \
+      check_failed(__FILE__, __LINE__, #actual " == " #expected); \
+    } \
+  } while (0)
+
+// Prints the result of the test program and returns its exit status
+static int check_summary(const char * name) {
+  printf("%s: %u checks, %u failed\n", name, checks_run, checks_failed);
+
+  return (checks_failed == 0) ? 0 : 1;
+}
+
+#endif // #ifndef _CHECK_H_
@@ -0,0 +1,142 @@
+/*
+ * file: test_compass.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Unit tests for the compass driver's sampling, against a simulated compass
+ * on the simulated TWI bus. compass.c is compiled into this file so its
+ * running sums can be checked directly, so the sketch must turn on
+ * KINTOBOR_WITH_COMPASS (the default sketch, demo_sgconzm, does).
+ */
+#include <string.h>
+
+#include "check.h"
+#include "hal.h"
+#include "kintobor_config.h"
+#include "statevars.h"
+#include "timebase.h"
+
+#include "compass.c"
+
+#if !KINTOBOR_WITH_COMPASS
+#error "test_compass needs a sketch built with KINTOBOR_WITH_COMPASS"
+#endif
+
+#define BUSY_ADDR       0x70    // a device whose reads keep the bus busy
+#define BUSY_READ_LEN   32
+#define CYCLES_PER_MS   (F_CPU / 1000)
+
+statevars_t statevars;
+
+static uint8_t compass_regs[32];
+static uint8_t compass_reg;
+
+static uint8_t compass_start(void * context, uint8_t is_read) {
+  return 1;
+}
+
+static uint8_t compass_write(void * context, uint8_t data) {
+  compass_reg = data;
+
+  return 1;
+}
+
+static uint8_t compass_read(void * context) {
+  uint8_t reg = compass_reg++;
+
+  return (reg < sizeof(compass_regs)) ? compass_regs[reg] : 0;
+}
+
+static uint8_t busy_start(void * context, uint8_t is_read) {
+  return 1;
+}
+
+static uint8_t busy_read(void * context) {
+  return 0;
+}
+
+static const hal_host_twi_device_t compass_device = {
+  COMPASS_ADDR, NULL, compass_start, compass_write, compass_read, NULL
+};
+
+static const hal_host_twi_device_t busy_device = {
+  BUSY_ADDR, NULL, busy_start, NULL, busy_read, NULL
+};
+
+static uint8_t busy_data[TWI_QUEUE_SIZE][BUSY_READ_LEN];
+static twi_txn_t busy_txns[TWI_QUEUE_SIZE];
+
+// Fills the TWI queue with long reads from the busy device
+static void fill_twi_queue(void) {
+  uint8_t i;
+
+  for (i = 0; i < TWI_QUEUE_SIZE; i++) {
+    memset(&busy_txns[i], 0, sizeof(busy_txns[i]));
+    busy_txns[i].address = BUSY_ADDR;
+    busy_txns[i].read_data = busy_data[i];
+    busy_txns[i].read_len = BUSY_READ_LEN;
+    twi_submit(&busy_txns[i]);
+  }
+
+  return;
+}
+
+static void set_heading(uint16_t heading) {
+  compass_regs[COMPASS_HEADING_REG] = heading >> 8;
+  compass_regs[COMPASS_HEADING_REG + 1] = heading & 0xFF;
+
+  return;
+}
+
+// A reading that can't be queued is not taken for a new sample
+static void test_submit_failure(void) {
+  hal_host_reset();
+  memset(&statevars, 0, sizeof(statevars));
+  timebase_init();
+  twi_init(TWI_FREQ_FAST);
+  sei();
+  compass_init();
+
+  set_heading(900);
+
+  // The first update only asks for a reading
+  compass_update_all();
+  hal_host_advance(CYCLES_PER_MS);
+  CHECK(compass_txn.status == Twi_Done);
+  CHECK(sample_count == 0);
+
+  // The reading is added, but the next one can't be queued
+  fill_twi_queue();
+  compass_update_all();
+  CHECK(sample_count == 1);
+  CHECK(compass_txn.status == Twi_Idle);
+
+  // Nothing new has been read, so nothing new is added
+  compass_update_all();
+  CHECK(sample_count == 1);
+
+  // Once the queue has room, the next reading completes the average
+  hal_host_advance(10 * CYCLES_PER_MS);
+  compass_update_all();
+  CHECK(compass_txn.status != Twi_Idle);
+
+  set_heading(910);
+  hal_host_advance(CYCLES_PER_MS);
+  compass_update_all();
+
+  CHECK(sample_count == 0);
+  CHECK(statevars.compass_samples == COMPASS_AVG_SAMPLES);
+  CHECK(statevars.heading_raw == 905);
+  CHECK(statevars.compass_meta.valid);
+
+  return;
+}
+
+int main(void) {
+  hal_host_twi_attach(&compass_device);
+  hal_host_twi_attach(&busy_device);
+
+  test_submit_failure();
+
+  return check_summary("test_compass");
+}
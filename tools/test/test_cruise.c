@@ -0,0 +1,114 @@
+/*
+ * file: test_cruise.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Unit tests for the cruise controller: the feed-forward lookup, the
+ * proportional and integral terms, and the limits on the integral and the
+ * throttle. cruise.c is compiled into this file so the feed-forward lookup
+ * can be checked on its own, so the sketch must turn on KINTOBOR_WITH_MOBILITY
+ * (the default sketch, demo_sgconzm, does).
+ */
+#include <string.h>
+
+#include "check.h"
+#include "kintobor_config.h"
+#include "statevars.h"
+
+#include "cruise.c"
+
+#if !KINTOBOR_WITH_MOBILITY
+#error "test_cruise needs a sketch built with KINTOBOR_WITH_MOBILITY"
+#endif
+
+#define DT_MS 100
+
+statevars_t statevars;
+
+static void test_feedforward(void) {
+  CHECK(feedforward_us(0) == SPEED_NEUTRAL);
+  CHECK(feedforward_us(1000) == 1630);
+
+  // Halfway between the 1000 and 2000 mm/s entries
+  CHECK(feedforward_us(1500) == 1675);
+
+  // Held at the last entry beyond the end of the table
+  CHECK(feedforward_us(4500) == CRUISE_THROTTLE_MAX_US);
+  CHECK(feedforward_us(6000) == CRUISE_THROTTLE_MAX_US);
+
+  return;
+}
+
+static void test_proportional(void) {
+  memset(&statevars, 0, sizeof(statevars));
+  cruise_init();
+
+  // On speed, the throttle is the feed-forward alone
+  CHECK(cruise_update(1000, 1000, DT_MS) == 1630);
+  CHECK(statevars.cruise_error_mmps == 0);
+
+  // 1000 mm/s too slow, with no time for the integral: 13 * 1000 / 256 us
+  cruise_init();
+  CHECK(cruise_update(1000, 0, 0) == 1630 + 13 * 1000 / 256);
+  CHECK(statevars.cruise_error_mmps == 1000);
+  CHECK(statevars.cruise_feedforward_us == 1630);
+
+  return;
+}
+
+static void test_integral(void) {
+  memset(&statevars, 0, sizeof(statevars));
+  cruise_init();
+
+  // Too slow for long enough that the integral reaches its limit
+  uint16_t throttle = 0;
+  uint8_t i;
+  for (i = 0; i < 20; i++) {
+    throttle = cruise_update(1000, 500, DT_MS);
+  }
+
+  CHECK(statevars.cruise_integral_us == CRUISE_MAX_TRIM_US);
+  CHECK(throttle == 1630 + (13 * 500 / 256) + CRUISE_MAX_TRIM_US);
+
+  // Stopping clears it
+  CHECK(cruise_update(0, 500, DT_MS) == SPEED_NEUTRAL);
+  CHECK(statevars.cruise_integral_us == 0);
+  CHECK(statevars.cruise_error_mmps == 0);
+
+  return;
+}
+
+// The integral doesn't wind up while the throttle is held at either end
+static void test_saturation(void) {
+  memset(&statevars, 0, sizeof(statevars));
+  cruise_init();
+
+  uint8_t i;
+  for (i = 0; i < 20; i++) {
+    CHECK(cruise_update(4500, 0, DT_MS) == CRUISE_THROTTLE_MAX_US);
+  }
+  CHECK(statevars.cruise_integral_us == 0);
+
+  // Far too fast for a slow target: never below neutral
+  cruise_init();
+  for (i = 0; i < 20; i++) {
+    CHECK(cruise_update(300, 3000, DT_MS) == SPEED_NEUTRAL);
+  }
+  CHECK(statevars.cruise_integral_us == 0);
+
+  // A gap longer than CRUISE_MAX_DT_MS adds no more than one of that length
+  cruise_init();
+  cruise_update(1000, 500, 1000);
+  CHECK(statevars.cruise_integral_us == 26 * 500 * 100 / 1000 / 256);
+
+  return;
+}
+
+int main(void) {
+  test_feedforward();
+  test_proportional();
+  test_integral();
+  test_saturation();
+
+  return check_summary("test_cruise");
+}
@@ -0,0 +1,258 @@
+/*
+ * file: test_gps.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Unit tests for the GPS sentence checksum and parsers. gps.c is compiled into
+ * this file so its static functions can be called directly; the last tests
+ * feed sentences, whole and broken, through the USART2 ISR instead.
+ */
+#include <string.h>
+
+#include "check.h"
+#include "hal.h"
+#include "statevars.h"
+
+#include "gps.c"
+
+statevars_t statevars;
+
+static const char gpgga[] =
+    "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+static const char gpgga_no_fix[] =
+    "$GPGGA,123519,4807.038,S,01131.000,W,0,00,,,M,,M,,*5D\r\n";
+static const char gprmc[] =
+    "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n";
+
+// Copies a sentence into a zeroed buffer as large as the ISR's
+static char * load(char * buffer, const char * sentence) {
+  memset(buffer, 0, GPS_SENTENCE_BUFF_SZ);
+  strncpy(buffer, sentence, GPS_SENTENCE_BUFF_SZ - 1);
+
+  return buffer;
+}
+
+static void test_checksum(void) {
+  char buffer[GPS_SENTENCE_BUFF_SZ];
+
+  CHECK(validate_checksum(load(buffer, gpgga)) == 1);
+  CHECK(validate_checksum(load(buffer, gpgga_no_fix)) == 1);
+  CHECK(validate_checksum(load(buffer, gprmc)) == 1);
+
+  // One character changed
+  load(buffer, gpgga);
+  buffer[10] = '9';
+  CHECK(validate_checksum(buffer) == 0);
+
+  // A checksum that isn't hex, or is missing altogether
+  load(buffer, gpgga);
+  strchr(buffer, '*')[1] = 'G';
+  CHECK(validate_checksum(buffer) == 0);
+
+  load(buffer, gpgga);
+  *strchr(buffer, '*') = '\0';
+  CHECK(validate_checksum(buffer) == 0);
+
+  return;
+}
+
+static void test_gpgga(void) {
+  char buffer[GPS_SENTENCE_BUFF_SZ];
+
+  memset(&statevars, 0, sizeof(statevars));
+  initialize_gps_statevars();
+
+  parse_gps_sentence(load(buffer, gpgga), 1234);
+
+  CHECK(statevars.status & STATUS_GPS_GPGGA_RCVD);
+  CHECK(statevars.status & STATUS_GPS_FIX_AVAIL);
+  CHECK(statevars.gps_hours == 12);
+  CHECK(statevars.gps_minutes == 35);
+  CHECK_NEAR(statevars.gps_seconds, 19.0, 1e-6);
+  CHECK_NEAR(statevars.gps_latitude, 48.0 + 7.038 / 60.0, 1e-5);
+  CHECK_NEAR(statevars.gps_longitude, 11.0 + 31.0 / 60.0, 1e-5);
+  CHECK(statevars.gps_lat_deg == 48);
+  CHECK(statevars.gps_long_deg == 11);
+  CHECK(statevars.gps_satcount == 8);
+  CHECK_NEAR(statevars.gps_hdop, 0.9, 1e-6);
+  CHECK_NEAR(statevars.gps_msl_altitude_m, 545.4, 1e-4);
+  CHECK(statevars.gps_meta.valid);
+  CHECK(statevars.gps_meta.seq == 1);
+  CHECK(statevars.gps_meta.timestamp == 1234);
+
+  // The raw sentence is logged whether or not it parses
+  CHECK(strncmp(statevars.gps_sentence0, gpgga, strlen(gpgga)) == 0);
+
+  // Southern and western hemispheres, and no fix: the position is stamped
+  // but not valid
+  memset(&statevars, 0, sizeof(statevars));
+  initialize_gps_statevars();
+
+  parse_gps_sentence(load(buffer, gpgga_no_fix), 5678);
+
+  CHECK(statevars.status & STATUS_GPS_NO_FIX_AVAIL);
+  CHECK(!(statevars.status & STATUS_GPS_FIX_AVAIL));
+  CHECK_NEAR(statevars.gps_latitude, -(48.0 + 7.038 / 60.0), 1e-5);
+  CHECK_NEAR(statevars.gps_longitude, -(11.0 + 31.0 / 60.0), 1e-5);
+  CHECK(statevars.gps_meta.seq == 1);
+  CHECK(!statevars.gps_meta.valid);
+
+  // A bad checksum leaves the values alone
+  memset(&statevars, 0, sizeof(statevars));
+  initialize_gps_statevars();
+
+  load(buffer, gpgga);
+  buffer[10] = '9';
+  parse_gps_sentence(buffer, 1234);
+
+  CHECK(!(statevars.status & STATUS_GPS_GPGGA_RCVD));
+  CHECK(statevars.gps_meta.seq == 0);
+  CHECK(statevars.gps_satcount == 0);
+
+  return;
+}
+
+static void test_gprmc(void) {
+  char buffer[GPS_SENTENCE_BUFF_SZ];
+
+  memset(&statevars, 0, sizeof(statevars));
+  initialize_gps_statevars();
+
+  parse_gps_sentence(load(buffer, gprmc), 0);
+
+  CHECK(statevars.status & STATUS_GPS_GPRMC_RCVD);
+  CHECK_NEAR(statevars.gps_ground_speed_kt, 22.4, 1e-4);
+  CHECK_NEAR(statevars.gps_ground_course_deg, 84.4, 1e-4);
+  CHECK_STR(statevars.gps_date, "230394");
+
+  // A date field longer than the statevars field is cut short and ended
+  char long_date[] =
+      "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,23039412345,,*00";
+  parse_gprmc(long_date);
+  CHECK(strlen(statevars.gps_date) == GPS_DATE_WIDTH - 1);
+
+  return;
+}
+
+// Feeds the sentences one byte at a time through the USART2 ISR
+static void test_isr(void) {
+  hal_host_reset();
+  memset(&statevars, 0, sizeof(statevars));
+  gps_init();
+
+  const char * sentences[] = { gpgga, gprmc };
+  uint8_t i;
+  for (i = 0; i < 2; i++) {
+    const char * c;
+    for (c = sentences[i]; *c != '\0'; c++) {
+      hal_host_usart2_rx(*c);
+    }
+  }
+
+  gps_update();
+
+  CHECK(statevars.status & STATUS_GPS_GPGGA_RCVD);
+  CHECK(statevars.status & STATUS_GPS_GPRMC_RCVD);
+  CHECK(statevars.gps_satcount == 8);
+  CHECK_STR(statevars.gps_date, "230394");
+  CHECK(statevars.gps_meta.seq == 1);
+
+  // Every buffer was handed back to the ISR
+  for (i = 0; i < NUM_GPS_SENTENCE_BUFFS; i++) {
+    CHECK(gps_buffers[i].ready == 0);
+  }
+
+  return;
+}
+
+static void feed(const char * s) {
+  for (; *s != '\0'; s++) {
+    hal_host_usart2_rx(*s);
+  }
+
+  return;
+}
+
+// A stray '$' restarts the sentence in the buffer the ISR is filling and
+// leaves a buffer gps_update() holds alone
+static void test_isr_unexpected_start(void) {
+  hal_host_reset();
+  memset(&statevars, 0, sizeof(statevars));
+  gps_init();
+
+  // Buffer 0 is ready and waiting for gps_update()
+  feed(gpgga);
+  CHECK(gps_buffers[0].ready == 1);
+
+  char held[GPS_SENTENCE_BUFF_SZ];
+  memcpy(held, gps_buffers[0].sentence, sizeof(held));
+
+  feed("$GPRMC,1235");
+  feed(gprmc);
+
+  CHECK(memcmp(gps_buffers[0].sentence, held, sizeof(held)) == 0);
+  CHECK(gps_buffers[1].ready == 1);
+  CHECK_STR(gps_buffers[1].sentence, gprmc);
+
+  gps_update();
+
+  CHECK(statevars.status & STATUS_GPS_UNEXPECT_START);
+  CHECK(statevars.status & STATUS_GPS_GPGGA_RCVD);
+  CHECK(statevars.status & STATUS_GPS_GPRMC_RCVD);
+
+  return;
+}
+
+// A sentence too long for a buffer is dropped without writing past the end
+// of it or into a buffer gps_update() holds
+static void test_isr_overflow(void) {
+  hal_host_reset();
+  memset(&statevars, 0, sizeof(statevars));
+  gps_init();
+
+  // Buffers 0 and 1 are ready, so the long sentence goes into buffer 2
+  feed(gpgga);
+  feed(gprmc);
+
+  char held[2][GPS_SENTENCE_BUFF_SZ];
+  memcpy(held[0], gps_buffers[0].sentence, sizeof(held[0]));
+  memcpy(held[1], gps_buffers[1].sentence, sizeof(held[1]));
+
+  feed("$GPGGA,");
+  uint16_t i;
+  for (i = 0; i < GPS_SENTENCE_BUFF_SZ * 2; i++) {
+    hal_host_usart2_rx('9');
+  }
+  feed("*00\r\n");
+
+  CHECK(memcmp(gps_buffers[0].sentence, held[0], sizeof(held[0])) == 0);
+  CHECK(memcmp(gps_buffers[1].sentence, held[1], sizeof(held[1])) == 0);
+  CHECK(gps_buffers[2].ready == 1);
+  CHECK(strlen(gps_buffers[2].sentence) < GPS_SENTENCE_BUFF_SZ);
+  CHECK(gps_buffers[3].ready == 0);
+
+  // What is left of the long sentence isn't taken for one
+  gps_update();
+
+  CHECK(statevars.status & STATUS_GPS_BUFF_OVERFLOW);
+  CHECK(statevars.gps_meta.seq == 1);
+  CHECK(statevars.gps_satcount == 8);
+
+  // The next sentence is received as usual
+  feed(gprmc);
+  gps_update();
+  CHECK_STR(statevars.gps_date, "230394");
+
+  return;
+}
+
+int main(void) {
+  test_checksum();
+  test_gpgga();
+  test_gprmc();
+  test_isr();
+  test_isr_unexpected_start();
+  test_isr_overflow();
+
+  return check_summary("test_gps");
+}
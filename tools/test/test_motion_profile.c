@@ -0,0 +1,129 @@
+/*
+ * file: test_motion_profile.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Unit tests for the motion profiles that shape the throttle and steering
+ * pulses: every update stays within the rate, acceleration, and jerk limits,
+ * and the setpoint lands on the target without overshooting it.
+ */
+#include <stdlib.h>
+
+#include "check.h"
+#include "motion_profile.h"
+
+#define DT_MS       10
+#define MAX_UPDATES 200
+
+static const profile_limits_t trapezoid = { 4000, 40000, 0 };
+static const profile_limits_t s_curve = { 8000, 40000, 800000 };
+
+/* Moves the profile from start_us to target_us in DT_MS updates and checks
+ * each update against the limits. The update that lands on the target stops
+ * the motion outright, so only its step is checked.
+ */
+static void run_to(const profile_limits_t * limits, uint16_t start_us,
+                   uint16_t target_us) {
+  profile_t p;
+  profile_init(&p, limits, start_us);
+
+  int32_t direction = (target_us > start_us) ? 1 : -1;
+  uint16_t setpoint = start_us;
+  int32_t rate = 0;
+  int32_t accel = 0;
+  uint8_t overshot = 0;
+  uint8_t too_fast = 0;
+  uint8_t too_sudden = 0;
+  uint8_t too_jerky = 0;
+  uint16_t updates;
+
+  for (updates = 1; updates <= MAX_UPDATES; updates++) {
+    uint16_t next = profile_update(&p, target_us, DT_MS);
+
+    if ((int32_t) (next - target_us) * direction > 0) {
+      overshot = 1;
+    }
+
+    // One microsecond more than the limit allows for the rounding
+    if (abs((int32_t) next - setpoint) >
+        limits->max_rate * DT_MS / 1000 + 1) {
+      too_fast = 1;
+    }
+
+    setpoint = next;
+
+    if (setpoint == target_us) {
+      break;
+    }
+
+    if (abs(p.rate - rate) > limits->max_accel * DT_MS / 1000) {
+      too_sudden = 1;
+    }
+
+    if (limits->max_jerk != 0 &&
+        labs(p.accel - accel) > (long) (limits->max_jerk * DT_MS / 1000)) {
+      too_jerky = 1;
+    }
+
+    rate = p.rate;
+    accel = p.accel;
+  }
+
+  CHECK(!overshot);
+  CHECK(!too_fast);
+  CHECK(!too_sudden);
+  CHECK(!too_jerky);
+  CHECK(setpoint == target_us);
+
+  // Once there, it stays there
+  CHECK(profile_update(&p, target_us, DT_MS) == target_us);
+  CHECK(p.rate == 0);
+
+  return;
+}
+
+static void test_trapezoid(void) {
+  run_to(&trapezoid, 1500, 1900);
+  run_to(&trapezoid, 1900, 1100);
+
+  // A short move never reaches full rate
+  run_to(&trapezoid, 1500, 1510);
+
+  return;
+}
+
+static void test_s_curve(void) {
+  run_to(&s_curve, 1500, 2000);
+  run_to(&s_curve, 1500, 1000);
+
+  return;
+}
+
+static void test_elapsed_time(void) {
+  profile_t p;
+
+  profile_init(&p, &trapezoid, 1500);
+
+  // No time has passed, so nothing moves
+  CHECK(profile_update(&p, 1900, 0) == 1500);
+
+  // A long gap counts as PROFILE_MAX_DT_MS, so the setpoint moves no more
+  // than 4000 us/s * 0.1 s = 400 us
+  uint16_t setpoint = profile_update(&p, 2000, 1000);
+  CHECK(setpoint > 1500 && setpoint <= 1900);
+
+  // A reset stops the motion where it is put
+  profile_reset(&p, 1700);
+  CHECK(p.rate == 0);
+  CHECK(profile_update(&p, 1700, DT_MS) == 1700);
+
+  return;
+}
+
+int main(void) {
+  test_trapezoid();
+  test_s_curve();
+  test_elapsed_time();
+
+  return check_summary("test_motion_profile");
+}
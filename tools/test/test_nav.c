@@ -0,0 +1,157 @@
+/*
+ * file: test_nav.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Unit tests for the navigation math: angle wrapping, great-circle distance
+ * and bearing, and dead reckoning; and for the steering pulse the heading
+ * controller asks for. kintobor.c is compiled into this file so its static
+ * functions can be called directly, so the sketch must turn on
+ * KINTOBOR_WITH_NAV and KINTOBOR_WITH_CONTROL (the default sketch,
+ * demo_sgconzm, does).
+ */
+#include <string.h>
+
+#include "check.h"
+#include "kintobor_config.h"
+#include "statevars.h"
+
+// demo_hdg_steer's gain, which asks for pulses far outside the steering range
+#define K_PROP 10
+
+#include "kintobor.c"
+
+#if !KINTOBOR_WITH_NAV || !KINTOBOR_WITH_CONTROL
+#error "test_nav needs a sketch built with KINTOBOR_WITH_NAV and _CONTROL"
+#endif
+
+statevars_t statevars;
+
+// One minute of arc along a meridian, at the radius kintobor.c uses
+#define METERS_PER_ARC_MINUTE (EARTH_RADIUS_M * M_PI / (180.0 * 60.0))
+
+static void test_relative_bearing(void) {
+  CHECK_NEAR(calc_relative_bearing(90.0, 45.0), 45.0, 1e-4);
+  CHECK_NEAR(calc_relative_bearing(45.0, 90.0), -45.0, 1e-4);
+
+  // The short way round, across north
+  CHECK_NEAR(calc_relative_bearing(10.0, 350.0), 20.0, 1e-4);
+  CHECK_NEAR(calc_relative_bearing(350.0, 10.0), -20.0, 1e-4);
+  CHECK_NEAR(calc_relative_bearing(0.0, 225.0), 135.0, 1e-4);
+
+  return;
+}
+
+static void test_compass_heading(void) {
+  memset(&statevars, 0, sizeof(statevars));
+
+  statevars.heading_deg = 90.0;
+  CHECK_NEAR(calc_compass_heading(), 90.0 + MAGNETIC_DECLINATION, 1e-4);
+
+  // Past north it wraps back to a small heading
+  statevars.heading_deg = 359.0;
+  CHECK_NEAR(calc_compass_heading(), MAGNETIC_DECLINATION - 1.0, 1e-4);
+
+  return;
+}
+
+static void test_mid_angle(void) {
+  CHECK_NEAR(calc_mid_angle(80.0, 100.0), 90.0, 1e-4);
+  CHECK_NEAR(calc_mid_angle(100.0, 80.0), 90.0, 1e-4);
+
+  // Either side of north
+  CHECK_NEAR(calc_mid_angle(350.0, 30.0), 10.0, 1e-4);
+  CHECK_NEAR(calc_mid_angle(330.0, 10.0), 350.0, 1e-4);
+
+  return;
+}
+
+static void test_distance(void) {
+  CHECK_NEAR(calc_dist_to_waypoint(40.0, -105.0, 40.0, -105.0), 0.0, 1e-3);
+
+  // One minute of latitude anywhere, one minute of longitude on the equator
+  CHECK_NEAR(calc_dist_to_waypoint(40.0, -105.0, 40.0 + 1.0 / 60.0, -105.0),
+             METERS_PER_ARC_MINUTE, 1.0);
+  CHECK_NEAR(calc_dist_to_waypoint(0.0, 10.0, 0.0, 10.0 + 1.0 / 60.0),
+             METERS_PER_ARC_MINUTE, 1.0);
+
+  // At 60 degrees north a minute of longitude is half as long
+  CHECK_NEAR(calc_dist_to_waypoint(60.0, 10.0, 60.0, 10.0 + 1.0 / 60.0),
+             METERS_PER_ARC_MINUTE / 2.0, 1.0);
+
+  return;
+}
+
+static void test_true_bearing(void) {
+  CHECK_NEAR(calc_true_bearing(40.0, -105.0, 40.01, -105.0), 0.0, 0.01);
+  CHECK_NEAR(calc_true_bearing(40.0, -105.0, 40.0, -104.99), 90.0, 0.01);
+  CHECK_NEAR(calc_true_bearing(40.0, -105.0, 39.99, -105.0), 180.0, 0.01);
+  CHECK_NEAR(calc_true_bearing(40.0, -105.0, 40.0, -105.01), 270.0, 0.01);
+
+  return;
+}
+
+// Dead reckoning from a point should land where the distance and bearing
+// to that point say it is
+static void test_position(void) {
+  const float ref_lat = 40.0;
+  const float ref_long = -105.0;
+  const float headings[] = { 0.0, 45.0, 135.0, 270.0 };
+  uint8_t i;
+
+  for (i = 0; i < sizeof(headings) / sizeof(headings[0]); i++) {
+    float new_lat;
+    float new_long;
+
+    calc_position(&new_lat, &new_long, ref_lat, ref_long, 50.0, headings[i]);
+
+    CHECK_NEAR(calc_dist_to_waypoint(ref_lat, ref_long, new_lat, new_long),
+               50.0, 0.5);
+    CHECK_NEAR(calc_relative_bearing(
+                   calc_true_bearing(ref_lat, ref_long, new_lat, new_long),
+                   headings[i]),
+               0.0, 0.5);
+  }
+
+  return;
+}
+
+// Returns the steering pulse the controller asks for at a heading
+static uint16_t control_pwm_at(float heading_deg) {
+  xtrack_error = 0.0;
+  xtrack_error_sum = 0.0;
+  nav_heading_deg = heading_deg;
+
+  update_nav_control_values();
+
+  return statevars.control_steering_pwm;
+}
+
+static void test_control_steering_pwm(void) {
+  memset(&statevars, 0, sizeof(statevars));
+
+  CHECK(control_pwm_at(TARGET_HEADING) == TURN_NEUTRAL);
+
+  // 5 degrees either side is within the steering range
+  CHECK(control_pwm_at(TARGET_HEADING - 5.0) == TURN_NEUTRAL - 5 * K_PROP);
+  CHECK(control_pwm_at(TARGET_HEADING + 5.0) == TURN_NEUTRAL + 5 * K_PROP);
+
+  // 170 degrees either side asks for -200 and 3200 us; the pulses stop at
+  // full right and full left
+  CHECK(control_pwm_at(TARGET_HEADING - 170.0) == TURN_FULL_RIGHT);
+  CHECK(control_pwm_at(TARGET_HEADING + 170.0 - 360.0) == TURN_FULL_LEFT);
+
+  return;
+}
+
+int main(void) {
+  test_relative_bearing();
+  test_compass_heading();
+  test_mid_angle();
+  test_distance();
+  test_true_bearing();
+  test_position();
+  test_control_steering_pwm();
+
+  return check_summary("test_nav");
+}
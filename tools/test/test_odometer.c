@@ -0,0 +1,157 @@
+/*
+ * file: test_odometer.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Unit tests for the odometer: ticks captured by Timer5 (through
+ * hal_host_capture()) are counted in the direction the wheel is turning, and
+ * the speed is measured from their timestamps. odometer.c is compiled into
+ * this file so its ring can be checked directly, so the sketch must turn on
+ * KINTOBOR_WITH_ODOMETER (the default sketch, demo_sgconzm, does).
+ */
+#include <string.h>
+
+#include "check.h"
+#include "hal.h"
+#include "kintobor_config.h"
+#include "statevars.h"
+#include "timebase.h"
+
+#include "odometer.c"
+
+#if !KINTOBOR_WITH_ODOMETER
+#error "test_odometer needs a sketch built with KINTOBOR_WITH_ODOMETER"
+#endif
+
+#define CYCLES_PER_MS   (F_CPU / 1000)
+
+// The speed with period_ms between ticks; micrometers per millisecond is the
+// same as millimeters per second
+#define SPEED_MMPS(period_ms) (ODOMETER_UM_PER_TICK / (period_ms))
+
+statevars_t statevars;
+
+// Lets period_ms pass before each of the ticks
+static void tick_every(uint16_t period_ms, uint8_t ticks) {
+  uint8_t i;
+
+  for (i = 0; i < ticks; i++) {
+    hal_host_advance((uint64_t) period_ms * CYCLES_PER_MS);
+    hal_host_capture(5);
+  }
+
+  return;
+}
+
+static void start(void) {
+  hal_host_reset();
+  memset(&statevars, 0, sizeof(statevars));
+  timebase_init();
+  odometer_init();
+  sei();
+
+  return;
+}
+
+static void test_counts(void) {
+  start();
+
+  odometer_update();
+  CHECK(statevars.odometer_ticks == 0);
+  CHECK(odometer_get_tick_time() == 0);
+  CHECK(!statevars.odometer_meta.valid);
+
+  tick_every(20, 5);
+  odometer_update();
+
+  CHECK(odometer_get_fwd_count() == 5);
+  CHECK(statevars.odometer_ticks == 5);
+  CHECK(statevars.odometer_ticks_are_fwd);
+
+  // The counts are stamped with the time of the last tick
+  CHECK(statevars.odometer_meta.valid);
+  CHECK(statevars.odometer_meta.timestamp == odometer_get_tick_time());
+  CHECK_NEAR(odometer_get_tick_time(), 100.0 * TIMEBASE_TICKS_PER_MS, 2);
+
+  // Reverse ticks are counted on their own
+  odometer_set_direction(Direction_Reverse);
+  tick_every(20, 3);
+  odometer_update();
+
+  CHECK(odometer_get_fwd_count() == 5);
+  CHECK(odometer_get_rev_count() == 3);
+  CHECK(statevars.odometer_ticks == 3);
+  CHECK(!statevars.odometer_ticks_are_fwd);
+
+  odometer_reset();
+  CHECK(odometer_get_fwd_count() == 0);
+  CHECK(odometer_get_rev_count() == 0);
+  CHECK(odometer_get_tick_time() == 0);
+
+  return;
+}
+
+static void test_speed(void) {
+  start();
+
+  // A single tick has no period to measure
+  tick_every(10, 1);
+  odometer_update();
+  CHECK(statevars.odometer_speed_mmps == 0);
+  CHECK(statevars.odometer_speed_periods == 0);
+
+  // At speed, ODOMETER_SPEED_PERIODS periods are averaged
+  tick_every(10, ODOMETER_SPEED_PERIODS + 2);
+  odometer_update();
+  CHECK(statevars.odometer_speed_periods == ODOMETER_SPEED_PERIODS);
+  CHECK_NEAR(statevars.odometer_speed_span,
+             ODOMETER_SPEED_PERIODS * 10 * TIMEBASE_TICKS_PER_MS, 2);
+  CHECK_NEAR(statevars.odometer_speed_mmps, SPEED_MMPS(10), 2);
+
+  // Slower, the average stops short of ODOMETER_SPEED_SPAN_TICKS: four
+  // periods of 45 ms fit in 200 ms, five don't
+  tick_every(45, 6);
+  odometer_update();
+  CHECK(statevars.odometer_speed_periods == 4);
+  CHECK_NEAR(statevars.odometer_speed_mmps, SPEED_MMPS(45), 2);
+
+  // No tick for longer than the average period: the speed decays with the
+  // time since the last tick
+  hal_host_advance(100 * CYCLES_PER_MS);
+  odometer_update();
+  CHECK(statevars.odometer_speed_periods == 1);
+  CHECK_NEAR(statevars.odometer_speed_mmps, SPEED_MMPS(100), 2);
+
+  // ...until the wheel counts as stopped
+  hal_host_advance(1100 * CYCLES_PER_MS);
+  odometer_update();
+  CHECK(statevars.odometer_speed_mmps == 0);
+  CHECK(odometer_get_speed_mmps() == 0);
+
+  return;
+}
+
+// The ring keeps only the newest ODOMETER_RING_SIZE ticks
+static void test_ring(void) {
+  start();
+
+  tick_every(10, ODOMETER_RING_SIZE + 5);
+  odometer_update();
+
+  CHECK(tick_count == ODOMETER_RING_SIZE);
+  CHECK(tick_head == (uint8_t) (ODOMETER_RING_SIZE + 5));
+  CHECK(odometer_get_fwd_count() == ODOMETER_RING_SIZE + 5);
+  CHECK_NEAR(odometer_get_tick_time(),
+             (ODOMETER_RING_SIZE + 5) * 10.0 * TIMEBASE_TICKS_PER_MS, 2);
+  CHECK_NEAR(statevars.odometer_speed_mmps, SPEED_MMPS(10), 2);
+
+  return;
+}
+
+int main(void) {
+  test_counts();
+  test_speed();
+  test_ring();
+
+  return check_summary("test_odometer");
+}
@@ -0,0 +1,214 @@
+/*
+ * file: test_scheduler.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Unit tests for the scheduler's accounting: task runs, durations, deadline
+ * overruns, frames that run so long that Timer1 wraps, and background job
+ * timing. Tasks and jobs stand in for real work by letting simulated time
+ * pass. scheduler.c is compiled into this file so its job queue can be
+ * checked directly.
+ */
+#include <string.h>
+
+#include "check.h"
+#include "hal.h"
+#include "statevars.h"
+
+#include "scheduler.c"
+
+#define CYCLES_PER_TICK (F_CPU / 1000 / SCHED_TICKS_PER_MS)
+
+statevars_t statevars;
+
+// How long each test task and job takes, in Timer1 ticks
+static uint16_t fast_ticks;
+static uint16_t slow_ticks;
+static uint16_t job_ticks;
+
+static void fast_task(void) {
+  hal_host_advance((uint64_t) fast_ticks * CYCLES_PER_TICK);
+
+  return;
+}
+
+static void slow_task(void) {
+  hal_host_advance((uint64_t) slow_ticks * CYCLES_PER_TICK);
+
+  return;
+}
+
+static uint8_t test_job(void) {
+  hal_host_advance((uint64_t) job_ticks * CYCLES_PER_TICK);
+
+  return SCHED_JOB_DONE;
+}
+
+static uint8_t waiting_job(void) {
+  return SCHED_JOB_WAIT;
+}
+
+static const sched_task_t tasks[] = {
+  // run        period  offset  deadline
+  { fast_task,  1,      0,      2 * SCHED_TICKS_PER_MS },
+  { slow_task,  2,      1,      5 * SCHED_TICKS_PER_MS }
+};
+
+#define NUM_TASKS (sizeof(tasks) / sizeof(tasks[0]))
+
+static void start(void) {
+  hal_host_reset();
+  memset(&statevars, 0, sizeof(statevars));
+
+  fast_ticks = SCHED_TICKS_PER_MS;
+  slow_ticks = SCHED_TICKS_PER_MS;
+  job_ticks = 0;
+
+  sched_init(tasks, NUM_TASKS);
+  sched_start();
+
+  return;
+}
+
+static void run_frames(uint8_t frames) {
+  uint8_t i;
+
+  for (i = 0; i < frames; i++) {
+    sched_run_frame();
+  }
+
+  return;
+}
+
+static void test_init(void) {
+  const sched_task_t bad_offset[] = { { fast_task, 2, 2, 0 } };
+  const sched_task_t bad_deadline[] = {
+    { fast_task, 1, 0, SCHED_FRAME_TICKS + 1 }
+  };
+
+  CHECK(!sched_init(NULL, 1));
+  CHECK(!sched_init(tasks, 0));
+  CHECK(!sched_init(bad_offset, 1));
+  CHECK(!sched_init(bad_deadline, 1));
+  CHECK(sched_init(tasks, NUM_TASKS));
+
+  return;
+}
+
+static void test_runs(void) {
+  start();
+  run_frames(4);
+
+  CHECK(sched_get_frame_count() == 4);
+  CHECK(statevars.sched_task_runs[0] == 4);
+  CHECK(statevars.sched_task_runs[1] == 2);
+
+  // Each task is timed to within a few ticks of what it took
+  CHECK_NEAR(statevars.sched_task_ticks[0], SCHED_TICKS_PER_MS, 4);
+  CHECK_NEAR(statevars.sched_task_max_ticks[1], SCHED_TICKS_PER_MS, 4);
+  CHECK_NEAR(statevars.sched_task_mean_ticks[0], SCHED_TICKS_PER_MS, 4);
+
+  // Two tasks ran in the busiest frames, and the rest was slack
+  CHECK_NEAR(statevars.sched_min_slack_ticks,
+             SCHED_FRAME_TICKS - 2 * SCHED_TICKS_PER_MS, 8);
+
+  CHECK(statevars.sched_overruns[0] == 0);
+  CHECK(statevars.sched_overruns[1] == 0);
+  CHECK(!(statevars.status & STATUS_SCHED_OVERRUN));
+  CHECK(!(statevars.status & STATUS_SYS_TIMER_OVERFLOW));
+
+  return;
+}
+
+// An overrun is counted against the task that finished late, every time
+static void test_overruns(void) {
+  start();
+
+  // The slow task finishes 1 + 5 = 6 ms into the frame; its deadline is 5
+  slow_ticks = 5 * SCHED_TICKS_PER_MS;
+  run_frames(4);
+
+  CHECK(statevars.sched_overruns[0] == 0);
+  CHECK(statevars.sched_overruns[1] == 2);
+  CHECK(statevars.status & STATUS_SCHED_OVERRUN);
+  CHECK(statevars.sched_min_slack_ticks < SCHED_FRAME_TICKS -
+                                          6 * SCHED_TICKS_PER_MS);
+
+  // A task that runs for longer than the frame makes the next frame start
+  // right away rather than wait for one that has already gone by. The slow
+  // task runs in odd frames
+  start();
+  slow_ticks = 2 * SCHED_FRAME_TICKS;
+  sched_run_frame();
+  uint64_t started = hal_host_cycles();
+  sched_run_frame();
+
+  CHECK(statevars.sched_overruns[1] == 1);
+  CHECK(statevars.sched_slack_ticks == 0);
+  CHECK(hal_host_cycles() - started <
+        (uint64_t) (fast_ticks + slow_ticks + SCHED_TICKS_PER_MS) *
+        CYCLES_PER_TICK);
+
+  // So long that Timer1 wraps around: flagged at the start of the next frame
+  start();
+  slow_ticks = 0xFFFF;
+  run_frames(2);
+  CHECK(!(statevars.status & STATUS_SYS_TIMER_OVERFLOW));
+  sched_run_frame();
+  CHECK(statevars.status & STATUS_SYS_TIMER_OVERFLOW);
+
+  return;
+}
+
+static void test_jobs(void) {
+  start();
+
+  // A job that takes longer than it declared
+  job_ticks = 200;
+  CHECK(sched_post_job(test_job, 100));
+  run_frames(1);
+
+  CHECK(statevars.sched_jobs_done == 1);
+  CHECK_NEAR(statevars.sched_job_max_ticks, 200, 4);
+  CHECK_NEAR(statevars.sched_job_max_over_ticks, 100, 4);
+  CHECK(statevars.sched_job_overruns == 0);
+
+  // A job whose step would never fit in the slack is never started
+  CHECK(sched_post_job(test_job, SCHED_FRAME_TICKS));
+  run_frames(2);
+  CHECK(statevars.sched_jobs_done == 1);
+  CHECK(job_count == 1);
+
+  // A step that runs past the end of the frame is counted
+  start();
+  job_ticks = SCHED_FRAME_TICKS;
+  CHECK(sched_post_job(test_job, 1));
+  run_frames(1);
+  CHECK(statevars.sched_jobs_done == 1);
+  CHECK(statevars.sched_job_overruns == 1);
+
+  // The queue holds SCHED_MAX_JOBS jobs; more are dropped and counted
+  start();
+  uint8_t i;
+  for (i = 0; i < SCHED_MAX_JOBS; i++) {
+    CHECK(sched_post_job(waiting_job, 1));
+  }
+  CHECK(!sched_post_job(waiting_job, 1));
+  CHECK(statevars.sched_jobs_dropped == 1);
+
+  // Waiting jobs stay queued without holding up the frame
+  run_frames(2);
+  CHECK(job_count == SCHED_MAX_JOBS);
+  CHECK(statevars.sched_idle_ticks > 0);
+
+  return;
+}
+
+int main(void) {
+  test_init();
+  test_runs();
+  test_overruns();
+  test_jobs();
+
+  return check_summary("test_scheduler");
+}
@@ -0,0 +1,251 @@
+/*
+ * file: test_twi_master.c
+ * created: 20261018
+ * author(s): mr-augustine
+ *
+ * Unit tests for the queued TWI master against simulated devices on the
+ * simulated bus: transactions run in the order they were queued, a full
+ * queue turns new ones away, and a NACK, a bus error, or a timeout fails only
+ * the transaction it happened to. twi_master.c is compiled into this file so
+ * its queue can be checked directly.
+ */
+#include <string.h>
+
+#include "check.h"
+#include "hal.h"
+#include "statevars.h"
+#include "timebase.h"
+
+#include "twi_master.c"
+
+#define DEVICE_ADDR     0x21
+#define PICKY_ADDR      0x22    // NACKs every byte written to it
+#define MISSING_ADDR    0x23    // nothing answers
+#define CYCLES_PER_MS   (F_CPU / 1000)
+
+statevars_t statevars;
+
+static uint8_t device_regs[16];
+static uint8_t device_reg;
+
+static uint8_t device_write(void * context, uint8_t data) {
+  device_reg = data;
+
+  return 1;
+}
+
+static uint8_t device_read(void * context) {
+  uint8_t reg = device_reg++;
+
+  return (reg < sizeof(device_regs)) ? device_regs[reg] : 0;
+}
+
+static uint8_t picky_write(void * context, uint8_t data) {
+  return 0;
+}
+
+static const hal_host_twi_device_t device = {
+  DEVICE_ADDR, NULL, NULL, device_write, device_read, NULL
+};
+
+static const hal_host_twi_device_t picky = {
+  PICKY_ADDR, NULL, NULL, picky_write, NULL, NULL
+};
+
+// Reads two registers starting at each transaction's own register
+static uint8_t txn_regs[TWI_QUEUE_SIZE + 1];
+static uint8_t txn_data[TWI_QUEUE_SIZE + 1][2];
+static twi_txn_t txns[TWI_QUEUE_SIZE + 1];
+
+static uint8_t callbacks;
+
+static void count_callback(twi_txn_t * txn) {
+  callbacks++;
+
+  return;
+}
+
+static void prepare(uint8_t i, uint8_t address) {
+  txn_regs[i] = 2 * i;
+  memset(txn_data[i], 0, sizeof(txn_data[i]));
+  memset(&txns[i], 0, sizeof(txns[i]));
+
+  txns[i].address = address;
+  txns[i].write_data = &txn_regs[i];
+  txns[i].write_len = 1;
+  txns[i].read_data = txn_data[i];
+  txns[i].read_len = sizeof(txn_data[i]);
+  txns[i].done = count_callback;
+
+  return;
+}
+
+static void start(void) {
+  uint8_t i;
+
+  hal_host_reset();
+  memset(&statevars, 0, sizeof(statevars));
+  timebase_init();
+  twi_init(TWI_FREQ_FAST);
+  sei();
+
+  for (i = 0; i < sizeof(device_regs); i++) {
+    device_regs[i] = 0xA0 + i;
+  }
+
+  callbacks = 0;
+
+  return;
+}
+
+static void test_init(void) {
+  CHECK(!twi_init(0));
+  CHECK(!twi_init(F_CPU));
+
+  // Slower than TWBR can divide the clock down to
+  CHECK(!twi_init(20000));
+  CHECK(twi_init(TWI_FREQ_STANDARD));
+
+  return;
+}
+
+static void test_queue(void) {
+  uint8_t i;
+
+  start();
+
+  for (i = 0; i < TWI_QUEUE_SIZE; i++) {
+    prepare(i, DEVICE_ADDR);
+    CHECK(twi_submit(&txns[i]));
+  }
+
+  // The first one is already on the bus
+  CHECK(txns[0].status == Twi_Busy);
+  CHECK(txns[1].status == Twi_Pending);
+
+  // No room for another, and one that is queued can't be queued twice
+  prepare(TWI_QUEUE_SIZE, DEVICE_ADDR);
+  CHECK(!twi_submit(&txns[TWI_QUEUE_SIZE]));
+  CHECK(!twi_submit(&txns[1]));
+  CHECK(!twi_submit(NULL));
+
+  hal_host_advance(5 * CYCLES_PER_MS);
+
+  for (i = 0; i < TWI_QUEUE_SIZE; i++) {
+    CHECK(twi_txn_is_finished(&txns[i]));
+    CHECK(txns[i].status == Twi_Done);
+    CHECK(txn_data[i][0] == 0xA0 + 2 * i);
+    CHECK(txn_data[i][1] == 0xA1 + 2 * i);
+    CHECK(txns[i].bus_ticks > 0);
+
+    // Back to back, in the order they were queued
+    if (i > 0) {
+      CHECK(txns[i].finished_at >= txns[i - 1].finished_at);
+    }
+  }
+
+  CHECK(callbacks == TWI_QUEUE_SIZE);
+  CHECK(queue_count == 0);
+
+  // A finished transaction can be submitted again
+  CHECK(twi_submit(&txns[0]));
+  hal_host_advance(CYCLES_PER_MS);
+  CHECK(txns[0].status == Twi_Done);
+
+  return;
+}
+
+// A NACK fails its own transaction, and the next one still runs
+static void test_nack(void) {
+  start();
+
+  prepare(0, MISSING_ADDR);
+  prepare(1, PICKY_ADDR);
+  prepare(2, DEVICE_ADDR);
+  CHECK(twi_submit(&txns[0]));
+  CHECK(twi_submit(&txns[1]));
+  CHECK(twi_submit(&txns[2]));
+
+  hal_host_advance(2 * CYCLES_PER_MS);
+
+  CHECK(txns[0].status == Twi_Error_Nack);
+  CHECK(txns[1].status == Twi_Error_Nack);
+  CHECK(txns[2].status == Twi_Done);
+  CHECK(txn_data[2][0] == 0xA4);
+  CHECK(statevars.twi_nacks == 2);
+  CHECK(statevars.twi_bus_errors == 0);
+  CHECK(callbacks == 3);
+
+  return;
+}
+
+static void test_bus_error(void) {
+  start();
+
+  prepare(0, DEVICE_ADDR);
+  prepare(1, DEVICE_ADDR);
+  CHECK(twi_submit(&txns[0]));
+  CHECK(twi_submit(&txns[1]));
+
+  // The hardware reports an illegal START or STOP in the middle of the first
+  hal_host_advance(CYCLES_PER_MS / 50);
+  cli();
+  TWSR = TW_BUS_ERROR;
+  TWI_vect();
+  sei();
+
+  hal_host_advance(2 * CYCLES_PER_MS);
+
+  CHECK(txns[0].status == Twi_Error_Bus);
+  CHECK(txns[1].status == Twi_Done);
+  CHECK(statevars.twi_bus_errors == 1);
+
+  return;
+}
+
+// A transaction that makes no progress is failed by twi_poll()
+static void test_timeout(void) {
+  start();
+
+  prepare(0, DEVICE_ADDR);
+  prepare(1, DEVICE_ADDR);
+
+  // With interrupts held off the transaction is stuck on the bus, as it is
+  // when a slave holds the clock low
+  cli();
+  CHECK(twi_submit(&txns[0]));
+  CHECK(twi_submit(&txns[1]));
+  hal_host_advance(2 * CYCLES_PER_MS);
+
+  // Not yet
+  twi_poll();
+  CHECK(txns[0].status == Twi_Busy);
+
+  hal_host_advance(TWI_TIMEOUT_TICKS * CYCLES_PER_MS / TIMEBASE_TICKS_PER_MS);
+  twi_poll();
+
+  CHECK(txns[0].status == Twi_Error_Timeout);
+  CHECK(statevars.twi_timeouts == 1);
+  CHECK(txns[0].bus_ticks > TWI_TIMEOUT_TICKS);
+
+  // The next one starts over on a reset bus
+  sei();
+  hal_host_advance(2 * CYCLES_PER_MS);
+  CHECK(txns[1].status == Twi_Done);
+  CHECK(txn_data[1][0] == 0xA2);
+
+  return;
+}
+
+int main(void) {
+  hal_host_twi_attach(&device);
+  hal_host_twi_attach(&picky);
+
+  test_init();
+  test_queue();
+  test_nack();
+  test_bus_error();
+  test_timeout();
+
+  return check_summary("test_twi_master");
+}